@@ -1,11 +1,16 @@
+# Chunk size in cells - 16, 24 or 32 build a separate variant next to the default 12
+param([int]$ChunkSize = 12)
+
 # Set the base directory of your project
 $baseDir = "$(Split-Path -Parent $MyInvocation.MyCommand.Path)"
 
+$exeName = if ($ChunkSize -eq 12) { "application.exe" } else { "application_$ChunkSize.exe" }
+
 # Compile main.cpp from src/ and create main.o
-& clang++ -std=c++20 -fopenmp -c "src\main.cpp" -I"$baseDir\libs\SFML\include" -I"$baseDir\libs\glew\include" 
+& clang++ -std=c++20 -fopenmp -mavx2 -DCHUNK_SIZE=$ChunkSize -c "src\main.cpp" -I"$baseDir\libs\SFML\include" -I"$baseDir\libs\glew\include" 
 
 # Link main.o and create the application executable
-& clang++ -o build\application.exe main.o -I"$baseDir\libs\SFML\include" -I"$baseDir\libs\glew\include" -L"$baseDir\libs\SFML\lib" -L"$baseDir\libs\glew\lib\Release\x64" -lopengl32 -lglew32 -lsfml-graphics -lsfml-window -lsfml-system -fopenmp
+& clang++ -o build\$exeName main.o -I"$baseDir\libs\SFML\include" -I"$baseDir\libs\glew\include" -L"$baseDir\libs\SFML\lib" -L"$baseDir\libs\glew\lib\Release\x64" -lopengl32 -lglew32 -lsfml-graphics -lsfml-window -lsfml-system -fopenmp
 
 
 # Copy the textures directory into the build directory
@@ -1,7 +1,7 @@
 #version 330 core
 
-layout (location = 0) in vec4 vertexPosition;
-layout (location = 1) in vec3 vertexNormal;
+layout (location = 0) in vec4 vertexPosition; // PACKED FIXED POINT STEPS, u_ModelPositionMatrix SCALES THEM
+layout (location = 1) in vec2 vertexNormal;   // OCTAHEDRAL
 layout (location = 2) in vec2 textureCoord;
 
 out vec3 v_Normal; // Output the normal
@@ -11,9 +11,19 @@ out vec3 FragPosWorld;
 uniform mat4 u_MVP;
 uniform mat4 u_ModelPositionMatrix;
 
+// SAME AS VertexPacking::UnpackNormal
+vec3 OctahedralNormal(vec2 e) {
+    e = max(e, vec2(-1.0));
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float fold = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -fold : fold;
+    n.y += n.y >= 0.0 ? -fold : fold;
+    return normalize(n);
+}
+
 void main() {
     gl_Position = u_MVP * vertexPosition;
-    v_Normal = vertexNormal; // Assign the normal attribute to the output
+    v_Normal = OctahedralNormal(vertexNormal); // Assign the normal attribute to the output
     v_TextCoord = textureCoord;
 
 
@@ -88,8 +88,27 @@ void Init()
     global.DebugMode = false;
 }
 
-int main() 
+int main(int argc, char** argv) 
 {
+    // --cpu-meshing MESHES CHUNKS ON THE WORKER THREADS INSTEAD OF THE COMPUTE SHADER
+    // --surface-nets MESHES THE WORLD WITH SURFACE NETS, ALWAYS ON THE WORKER THREADS
+    // --decimate SIMPLIFIES EVERY NEW CHUNK MESH WITHIN A BUDGET THAT GROWS WITH DISTANCE
+    // --density-error E FILLS NEAR CHUNKS WITH MULTI-RESOLUTION DENSITIES WITHIN E OF THE EXACT ONES (CPU MARCHING CUBES)
+    // --permutation-noise / --opensimplex2-noise CARVE THE CAVES WITH THAT 3D NOISE INSTEAD OF THE HASHED GRADIENTS
+    bool decimate = false;
+    float densityError = 0.0f;
+    MeshBackend meshBackend = MeshBackend::GPU;
+    MeshAlgorithm meshAlgorithm = MeshAlgorithm::MarchingCubes;
+    NoiseBackend noiseBackend = NoiseBackend::Hash;
+    for (int i=1; i<argc; ++i) {
+        if (std::string(argv[i]) == "--cpu-meshing") meshBackend = MeshBackend::CPU;
+        if (std::string(argv[i]) == "--surface-nets") meshAlgorithm = MeshAlgorithm::SurfaceNets;
+        if (std::string(argv[i]) == "--decimate") decimate = true;
+        if (std::string(argv[i]) == "--density-error" && i + 1 < argc) densityError = std::stof(argv[++i]);
+        if (std::string(argv[i]) == "--permutation-noise") noiseBackend = NoiseBackend::Permutation;
+        if (std::string(argv[i]) == "--opensimplex2-noise") noiseBackend = NoiseBackend::OpenSimplex2;
+    }
+
     sf::ContextSettings settings;
     settings.depthBits = 24;
     settings.antialiasingLevel = 4;
@@ -108,7 +127,9 @@ int main()
     float lookSensitivity = 0.16f;
 
 
-    TerrainSystem terrainSystem;
+    TerrainSystem terrainSystem(meshBackend, meshAlgorithm, noiseBackend);
+    terrainSystem.decimation = decimate;
+    terrainSystem.SetDensityError(densityError);
 
     // MAIN UPDATE LOOP
     while (window.isOpen()) 
@@ -162,7 +183,7 @@ int main()
 
 
         // Debug::StartTimer();
-        terrainSystem.Update(camera.position.x , camera.position.y, camera.position.z);
+        terrainSystem.Update(camera.position.x , camera.position.y, camera.position.z, camera.GetProjectionViewMatrix());
         // Debug::EndTimer();
         
 
@@ -195,6 +216,11 @@ int main()
         // DRAW FPS IN WINDOW TOOLBAR
         std::stringstream ss;
         ss << "SFML window - FPS: " << std::fixed << std::setprecision(0) << 1 / global.FRAME_TIME;
+        ss << " - Pending chunks: " << terrainSystem.scheduler.pendingChunks << " (" << terrainSystem.scheduler.pendingVisibleChunks << " visible)";
+        ss << " - Chunk cache: " << terrainSystem.cache.hits << " hits, " << terrainSystem.cache.misses << " misses, " << terrainSystem.regenerationsAvoided << " kept by hysteresis";
+        if (terrainSystem.trianglesBeforeDecimation > 0) {
+            ss << " - Decimation: " << 100 * (terrainSystem.trianglesBeforeDecimation - terrainSystem.trianglesAfterDecimation) / terrainSystem.trianglesBeforeDecimation << "% fewer triangles";
+        }
         std::string title = ss.str();
         window.setTitle(title);
     }
@@ -1,37 +1,140 @@
 #pragma once
 
 #include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
 #include "vendor/glm/glm.hpp"
 #include "raycast.h" // For Bounding Box
 
+// 8 BYTES PER VERTEX AGAINST 24 FOR POSITION AND NORMAL AS FLOATS
+struct PackedVertex
+{
+    uint16_t x, y, z; // FIXED POINT POSITION RELATIVE TO Model::position, SEE VertexPacking
+    int8_t nx, ny;    // OCTAHEDRAL NORMAL, SIGNED NORMALIZED
+};
+static_assert(sizeof(PackedVertex) == 8, "PackedVertex must match the attribute layout in RenderPipeline::Render");
+
+/*
+Quantization of model vertices. Positions are steps of 1/1024 from positionOrigin on each axis, so a model covers
+64 units around its position - a chunk (up to 32 cells plus its apron) fits with room to spare, and the error is
+under a thousandth of a unit. Normals are folded onto an octahedron, stored as 2 bytes (within about a degree) and
+unfolded in the vertex shader.
+The GPU decodes positions through the model matrix RenderPipeline::Render builds, never per vertex.
+*/
+namespace VertexPacking
+{
+    constexpr float positionStep = 1.0f / 1024.0f;
+    constexpr float positionOrigin = -32.0f;
+    constexpr float positionExtent = 65535.0f * positionStep; // LARGEST POSITION IS positionOrigin + positionExtent
+
+    inline uint16_t PackCoordinate(float value)
+    {
+        return static_cast<uint16_t>(std::clamp(std::round((value - positionOrigin) / positionStep), 0.0f, 65535.0f));
+    }
+
+    inline int8_t PackUnit(float value)
+    {
+        return static_cast<int8_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+    }
+
+    inline PackedVertex Pack(float x, float y, float z, float nx, float ny, float nz)
+    {
+        PackedVertex vertex;
+        vertex.x = PackCoordinate(x);
+        vertex.y = PackCoordinate(y);
+        vertex.z = PackCoordinate(z);
+
+        // PROJECT ONTO THE OCTAHEDRON |x| + |y| + |z| = 1, THEN FOLD THE LOWER HALF OVER THE UPPER
+        float sum = std::abs(nx) + std::abs(ny) + std::abs(nz);
+        float u = sum > 0.0f ? nx / sum : 0.0f;
+        float v = sum > 0.0f ? ny / sum : 0.0f;
+        if (nz < 0.0f)
+        {
+            float foldedU = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            float foldedV = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+        vertex.nx = PackUnit(u);
+        vertex.ny = PackUnit(v);
+        return vertex;
+    }
+
+    inline glm::vec3 UnpackPosition(const PackedVertex& vertex)
+    {
+        return glm::vec3(vertex.x, vertex.y, vertex.z) * positionStep + glm::vec3(positionOrigin);
+    }
+
+    // SAME AS OctahedralNormal IN shader.vert
+    inline glm::vec3 UnpackNormal(const PackedVertex& vertex)
+    {
+        float u = std::max(vertex.nx / 127.0f, -1.0f);
+        float v = std::max(vertex.ny / 127.0f, -1.0f);
+        glm::vec3 n(u, v, 1.0f - std::abs(u) - std::abs(v));
+        float fold = std::max(-n.z, 0.0f);
+        n.x += n.x >= 0.0f ? -fold : fold;
+        n.y += n.y >= 0.0f ? -fold : fold;
+        return glm::normalize(n);
+    }
+}
+
 class Model {
 public:
     Model() {}
-    ~Model() 
+    ~Model()
     {
         vertices.clear();
         indices.clear();
+        wideIndices.clear();
     }
 
-    void AddVertex(float x, float y, float z, float nx, float ny, float nz) 
+    // 16 BIT INDICES REACH maxVertices - A BIGGER MESH (A 32 WIDE CHUNK CAN MAKE ONE) FALLS BACK TO 32 BIT wideIndices
+    static constexpr int maxVertices = 65536;
+
+    // FILLS indices OR, WHEN THE VERTICES DON'T FIT 16 BITS, wideIndices - THE OTHER ONE IS LEFT EMPTY
+    void SetIndices(const std::vector<unsigned int>& source)
+    {
+        indices.clear();
+        wideIndices.clear();
+        if (vertices.size() > maxVertices) wideIndices.assign(source.begin(), source.end());
+        else indices.assign(source.begin(), source.end());
+    }
+
+    bool WideIndices() const
+    {
+        return !wideIndices.empty();
+    }
+
+    int IndexCount() const
+    {
+        return static_cast<int>(WideIndices() ? wideIndices.size() : indices.size());
+    }
+
+    unsigned int Index(int i) const
+    {
+        return WideIndices() ? wideIndices[i] : indices[i];
+    }
+
+    void AddVertex(float x, float y, float z, float nx, float ny, float nz)
     {
-        vertices.push_back(x);
-        vertices.push_back(y);
-        vertices.push_back(z);
-        vertices.push_back(nx);
-        vertices.push_back(ny);
-        vertices.push_back(nz);
-        // vertices.push_back(u);
-        // vertices.push_back(v);
+        vertices.push_back(VertexPacking::Pack(x, y, z, nx, ny, nz));
     }
 
     int VertexCount()
     {
-        return static_cast<int>(vertices.size()/6);
+        return static_cast<int>(vertices.size());
     }
-    
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+
+    // DECODED POSITION RELATIVE TO position
+    glm::vec3 VertexPosition(int index) const
+    {
+        return VertexPacking::UnpackPosition(vertices[index]);
+    }
+
+    std::vector<PackedVertex> vertices;
+    std::vector<uint16_t> indices;
+    std::vector<uint32_t> wideIndices;
     BoundingBox boundingBox;
     glm::vec3 position;
 };
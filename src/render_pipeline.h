@@ -8,6 +8,7 @@
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <cstddef>
 #include "model.h"
 #include "error.h"
 // #include "texture.h"
@@ -141,7 +142,9 @@ public:
             if (!InFrustum(*models[i], camera.GetProjectionViewMatrix())) continue;
 
             // transform uniforms
-            glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), models[i]->position);
+            // THE MODEL MATRIX ALSO TURNS PACKED POSITIONS BACK INTO MODEL SPACE - SEE VertexPacking
+            glm::mat4 modelMat = glm::translate(glm::mat4(1.0f), models[i]->position + glm::vec3(VertexPacking::positionOrigin));
+            modelMat = glm::scale(modelMat, glm::vec3(VertexPacking::positionStep));
             glm::mat4 mvp = camera.GetProjectionViewMatrix() * modelMat;
             glm::vec3 cameraPos = camera.position; 
 
@@ -163,17 +166,17 @@ public:
             unsigned int VBO;
             glGenBuffers(1, &VBO);
             glBindBuffer(GL_ARRAY_BUFFER, VBO);
-            glBufferData(GL_ARRAY_BUFFER, models[i]->vertices.size() * sizeof(float), models[i]->vertices.data(), GL_STATIC_DRAW);
+            glBufferData(GL_ARRAY_BUFFER, models[i]->vertices.size() * sizeof(PackedVertex), models[i]->vertices.data(), GL_STATIC_DRAW);
 
             // Vertex array object 
             unsigned int VAO;
             glGenVertexArrays(1, &VAO);
             glBindVertexArray(VAO);
-            // Position attribute
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)0);
+            // Position attribute - fixed point steps, scaled by the model matrix
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, x));
             glEnableVertexAttribArray(0);
-            // Normal attribute
-            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*)(3 * sizeof(float)));
+            // Normal attribute - octahedral, unfolded in the vertex shader
+            glVertexAttribPointer(1, 2, GL_BYTE, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, nx));
             glEnableVertexAttribArray(1);
             // UV attribute
             // glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
@@ -183,7 +186,9 @@ public:
             unsigned int IBO;
             glGenBuffers(1, &IBO);
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-            glBufferData(GL_ELEMENT_ARRAY_BUFFER, models[i]->indices.size() * sizeof(unsigned int), models[i]->indices.data(), GL_STATIC_DRAW);
+            bool wide = models[i]->WideIndices();
+            if (wide) glBufferData(GL_ELEMENT_ARRAY_BUFFER, models[i]->wideIndices.size() * sizeof(uint32_t), models[i]->wideIndices.data(), GL_STATIC_DRAW);
+            else glBufferData(GL_ELEMENT_ARRAY_BUFFER, models[i]->indices.size() * sizeof(uint16_t), models[i]->indices.data(), GL_STATIC_DRAW);
 
             // Bind Textures
             glActiveTexture(GL_TEXTURE0);
@@ -197,7 +202,7 @@ public:
 
             // Draw the model
             glBindVertexArray(VAO);
-            glDrawElements(GL_TRIANGLES, models[i]->indices.size(), GL_UNSIGNED_INT, nullptr);
+            glDrawElements(GL_TRIANGLES, models[i]->IndexCount(), wide ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT, nullptr);
 
             // Clean up resources
             glDeleteBuffers(1, &VBO);
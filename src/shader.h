@@ -46,6 +46,14 @@ std::string LoadShader(const std::string &filepath)
     return buffer.str();
 }
 
+// INSERTS #define LINES RIGHT AFTER THE #version LINE, WHICH MUST STAY FIRST
+std::string InjectDefines(const std::string& source, const std::string& defines)
+{
+    size_t versionEnd = source.find('\n', source.find("#version"));
+    if (versionEnd == std::string::npos) return defines + source;
+    return source.substr(0, versionEnd + 1) + defines + source.substr(versionEnd + 1);
+}
+
 unsigned int CompileShader(unsigned int type, const std::string &source)
 {
     unsigned int id = glCreateShader(type);
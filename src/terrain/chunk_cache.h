@@ -0,0 +1,108 @@
+#ifndef CHUNK_CACHE_H
+#define CHUNK_CACHE_H
+
+#include <list>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "../vendor/glm/glm.hpp"
+#include "../model.h"
+#include "chunk_classifier.h"
+#include "edit_overlay.h"
+#include "chunk_coords.h"
+
+/*
+Recently evicted chunks, kept so a chunk coming back into range is restored without going through the GPU again.
+Entries own the evicted mesh and edits (moved out of the chunk, never copied) and are dropped least recently
+evicted first once the cache is over its memory budget. Dropped entries are handed back so dirty edits can be saved.
+*/
+
+struct CachedChunk
+{
+    int x, y, z;
+    ChunkContents contents;
+    bool regenerate;
+    int lod;
+    int transitionMask;
+    float decimationError;
+    std::vector<PackedVertex> vertices;
+    std::vector<uint16_t> indices;
+    std::vector<uint32_t> wideIndices;
+    glm::vec3 position;
+    BoundingBox boundingBox;
+    std::shared_ptr<EditBrick> edits;
+    bool editsDirty;
+
+    size_t MemoryBytes() const
+    {
+        size_t bytes = sizeof(CachedChunk) + vertices.capacity() * sizeof(PackedVertex) + indices.capacity() * sizeof(uint16_t) +
+                       wideIndices.capacity() * sizeof(uint32_t);
+        if (edits) bytes += sizeof(EditBrick) + edits->values.capacity() * sizeof(float);
+        return bytes;
+    }
+};
+
+class ChunkCache
+{
+public:
+    size_t budgetBytes = 64 * 1024 * 1024; // 0 DISABLES THE CACHE
+
+    // RESTORES THAT FOUND / DIDN'T FIND THEIR CHUNK - FOR SIZING THE BUDGET
+    int hits = 0;
+    int misses = 0;
+
+    size_t MemoryBytes() const { return memoryBytes; }
+    int Count() const { return static_cast<int>(entries.size()); }
+
+    // ENTRIES PUSHED OUT TO STAY WITHIN BUDGET ARE APPENDED TO DROPPED
+    void Insert(CachedChunk&& chunk, std::vector<CachedChunk>& dropped)
+    {
+        uint64_t key = PackCoords(chunk.x, chunk.y, chunk.z);
+        auto found = index.find(key);
+        if (found != index.end()) Erase(found->second, dropped);
+
+        memoryBytes += chunk.MemoryBytes();
+        entries.push_front(std::move(chunk));
+        index[key] = entries.begin();
+
+        while (memoryBytes > budgetBytes && !entries.empty()) Erase(std::prev(entries.end()), dropped);
+    }
+
+    // MOVES THE ENTRY FOR (X, Y, Z) OUT OF THE CACHE
+    bool Take(int x, int y, int z, CachedChunk& out)
+    {
+        auto found = index.find(PackCoords(x, y, z));
+        if (found == index.end())
+        {
+            misses += 1;
+            return false;
+        }
+
+        hits += 1;
+        memoryBytes -= found->second->MemoryBytes();
+        out = std::move(*found->second);
+        entries.erase(found->second);
+        index.erase(found);
+        return true;
+    }
+
+    void DropAll(std::vector<CachedChunk>& dropped)
+    {
+        while (!entries.empty()) Erase(std::prev(entries.end()), dropped);
+    }
+
+private:
+    std::list<CachedChunk> entries; // MOST RECENTLY EVICTED FIRST
+    std::unordered_map<uint64_t, std::list<CachedChunk>::iterator> index;
+    size_t memoryBytes = 0;
+
+    void Erase(std::list<CachedChunk>::iterator entry, std::vector<CachedChunk>& dropped)
+    {
+        memoryBytes -= entry->MemoryBytes();
+        index.erase(PackCoords(entry->x, entry->y, entry->z));
+        dropped.push_back(std::move(*entry));
+        entries.erase(entry);
+    }
+};
+
+#endif
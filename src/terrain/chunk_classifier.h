@@ -0,0 +1,64 @@
+#ifndef CHUNK_CLASSIFIER_H
+#define CHUNK_CLASSIFIER_H
+
+#include <vector>
+#include "density_bounds.h"
+#include "edit_overlay.h"
+#include "chunk_config.h"
+
+// WHAT A CHUNK IS KNOWN TO CONTAIN BEFORE IT IS MESHED
+enum class ChunkContents
+{
+    Unknown,
+    Mixed,  // MAY CONTAIN SURFACE - NEEDS MESHING
+    Empty,  // EVERY CORNER IS AT OR BELOW THE DENSITY THRESHOLD
+    Solid   // EVERY CORNER IS ABOVE THE DENSITY THRESHOLD
+};
+
+// CHEAP CONSERVATIVE CLASSIFICATION OF A CHUNK FROM INTERVAL BOUNDS OF ITS DENSITY - NOTHING IS SAMPLED
+// surfaceHeights ARE THE CHUNK'S ColumnHeights, EDITS MAY BE NULL
+// FOR MIXED CHUNKS activeBlocks GETS ONE FLAG PER CELL BLOCK (ChunkConfig::blockSize CELLS A SIDE, X FASTEST):
+// 0 WHEN EVERY CORNER OF THE BLOCK IS ON THE SAME SIDE OF THE THRESHOLD, SO ITS CELLS CAN'T CONTAIN SURFACE
+// margin WIDENS THE BOUNDS FOR A MESHER WHOSE DENSITIES MAY BE THAT FAR FROM THE EXACT ONES (MULTI-RESOLUTION FILLS)
+inline ChunkContents ClassifyChunk(const float* surfaceHeights, int chunkX, int chunkY, int chunkZ, float densityThreshold, const EditBrick* edits, std::vector<int>& activeBlocks, float margin = 0.0f)
+{
+    using namespace ChunkConfig;
+    activeBlocks.clear();
+
+    Density::ChunkBounds bounds(surfaceHeights, chunkX, chunkY, chunkZ, edits);
+    int chunkMin[3] = { 0, 0, 0 };
+    int chunkMax[3] = { width, height, width };
+    Density::Interval density = bounds.Box(chunkMin, chunkMax);
+    density.min -= margin;
+    density.max += margin;
+    if (density.max <= densityThreshold) return ChunkContents::Empty;
+    if (density.min > densityThreshold) return ChunkContents::Solid;
+
+    // NEIGHBOURING BLOCKS SHARE CORNERS, SO IF NO BLOCK CROSSES THE THRESHOLD THEY ALL LIE ON THE SAME SIDE OF IT
+    activeBlocks.assign(blockCount, 0);
+    int active = 0;
+    bool above = false;
+    for (int bz=0; bz<blocksX; ++bz) {
+        for (int by=0; by<blocksY; ++by) {
+            for (int bx=0; bx<blocksX; ++bx) {
+                int c0[3] = { bx * blockSize, by * blockSize, bz * blockSize };
+                int c1[3] = { std::min(c0[0] + blockSize, width), std::min(c0[1] + blockSize, height), std::min(c0[2] + blockSize, width) };
+                Density::Interval block = bounds.Box(c0, c1);
+                block.min -= margin;
+                block.max += margin;
+                if (block.max > densityThreshold && block.min <= densityThreshold)
+                {
+                    activeBlocks[bx + by * blocksX + bz * blocksX * blocksY] = 1;
+                    active += 1;
+                }
+                above = block.min > densityThreshold;
+            }
+        }
+    }
+
+    if (active > 0) return ChunkContents::Mixed;
+    activeBlocks.clear();
+    return above ? ChunkContents::Solid : ChunkContents::Empty;
+}
+
+#endif
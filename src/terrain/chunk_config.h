@@ -0,0 +1,75 @@
+#ifndef CHUNK_CONFIG_H
+#define CHUNK_CONFIG_H
+
+#include <string>
+#include <algorithm>
+
+// CHUNK DIMENSIONS IN CELLS - BUILD WITH -DCHUNK_SIZE=16, 24 OR 32 FOR THE OTHER VARIANTS
+#ifndef CHUNK_SIZE
+#define CHUNK_SIZE 12
+#endif
+
+/*
+Chunk dimensions shared by the terrain system, the GPU mesher, the shader and the addressing code.
+Everything derived from them is a compile time constant so index arithmetic and buffer sizes fold.
+*/
+
+namespace ChunkConfig
+{
+    constexpr int width = CHUNK_SIZE;
+    constexpr int height = CHUNK_SIZE;
+
+    // CORNERS (DENSITY SAMPLES) PER CHUNK - ONE MORE THAN CELLS ON EACH AXIS
+    constexpr int cornersX = width + 1;
+    constexpr int cornersY = height + 1;
+    constexpr int cornerCount = cornersX * cornersY * cornersX;
+
+    constexpr int CornerIndex(int x, int y, int z)
+    {
+        return x + y * cornersX + z * cornersX * cornersY;
+    }
+
+    // CELL BLOCKS WHOSE DENSITY BOUNDS ARE CHECKED BEFORE MESHING - BLOCKS AT THE FAR EDGES MAY BE CUT SHORT
+    constexpr int blockSize = 4;
+    constexpr int blocksX = (width + blockSize - 1) / blockSize;
+    constexpr int blocksY = (height + blockSize - 1) / blockSize;
+    constexpr int blockCount = blocksX * blocksY * blocksX;
+
+    // ODD CHUNK COUNT COVERING ROUGHLY THE SAME DISTANCE WHATEVER THE CHUNK SIZE
+    constexpr int ChunksAcross(int cells, int chunkCells)
+    {
+        return ((cells + chunkCells / 2) / chunkCells) | 1;
+    }
+
+    // 204 x 108 x 204 CELLS - 17 x 9 x 17 CHUNKS OF 12
+    constexpr int renderDistanceH = ChunksAcross(204, width);
+    constexpr int renderDistanceV = ChunksAcross(108, height);
+
+    // GPU OUTPUT GROWS WITH THE CUBE OF THE CHUNK SIZE - 32 CHUNKS OF 12 PER BATCH, FEWER OF LARGER CHUNKS
+    constexpr int maxChunksPerBatch = std::max(1, 32 * 13 * 13 * 13 / cornerCount);
+
+    static_assert(width % 2 == 0 && height % 2 == 0, "LOD transitions need even chunk dimensions");
+
+    // COARSEST LOD WHOSE CELLS AND TRANSITION SQUARES STILL TILE THE CHUNK - STRIDE 8 AT MOST
+    constexpr int MaxLod()
+    {
+        int lod = 0;
+        while (lod < 3 && width % (2 << lod) == 0 && height % (2 << lod) == 0) lod += 1;
+        return lod;
+    }
+
+    // REGION FILES ARE ONLY VALID FOR THE CHUNK SIZE THEY WERE WRITTEN WITH, SO EACH VARIANT KEEPS ITS OWN WORLD
+    inline std::string WorldDirectory()
+    {
+        return width == 12 && height == 12 ? "world" : "world_" + std::to_string(width);
+    }
+
+    // PREPENDED TO THE COMPUTE SHADER SO IT SEES THE SAME DIMENSIONS
+    inline std::string ShaderDefines()
+    {
+        return "#define CHUNK_WIDTH " + std::to_string(width) + "\n#define CHUNK_HEIGHT " + std::to_string(height) + "\n" +
+               "#define BLOCK_SIZE " + std::to_string(blockSize) + "\n";
+    }
+}
+
+#endif
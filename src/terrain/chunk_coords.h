@@ -0,0 +1,27 @@
+#ifndef CHUNK_COORDS_H
+#define CHUNK_COORDS_H
+
+#include <cstdint>
+
+// INTEGER DIVISION ROUNDING TOWARDS NEGATIVE INFINITY - CHUNK AND REGION COORDINATES OF NEGATIVE POSITIONS
+inline int FloorDiv(int a, int b)
+{
+    int q = a / b;
+    if ((a % b != 0) && ((a < 0) != (b < 0))) q -= 1;
+    return q;
+}
+
+// A MOD N IN [0, N) FOR NEGATIVE A AS WELL
+inline int WrapIndex(int a, int n)
+{
+    int r = a % n;
+    return r < 0 ? r + n : r;
+}
+
+// PACKS A CHUNK OR REGION COORDINATE (21 BITS PER AXIS) INTO A HASH KEY
+inline uint64_t PackCoords(int x, int y, int z)
+{
+    return (static_cast<uint64_t>(x & 0x1FFFFF) << 42) | (static_cast<uint64_t>(y & 0x1FFFFF) << 21) | static_cast<uint64_t>(z & 0x1FFFFF);
+}
+
+#endif
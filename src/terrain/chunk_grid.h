@@ -0,0 +1,57 @@
+#ifndef CHUNK_GRID_H
+#define CHUNK_GRID_H
+
+#include <vector>
+#include "chunk_job.h"
+#include "chunk_coords.h"
+
+/*
+Fixed size 3D ring buffer of chunk slots.
+A chunk at chunk coordinate (cx, cy, cz) always lives in slot (cx mod sizeX, cy mod sizeY, cz mod sizeZ),
+so as long as the loaded region is never larger than the grid no two loaded chunks share a slot.
+Lookup, insert and evict are O(1) and never move other chunks.
+*/
+
+class ChunkGrid
+{
+public:
+    int sizeX = 0;
+    int sizeY = 0;
+    int sizeZ = 0;
+    std::vector<Chunk> slots;
+
+    void Init(int chunksX, int chunksY, int chunksZ, int chunkWidth, int chunkHeight)
+    {
+        sizeX = chunksX;
+        sizeY = chunksY;
+        sizeZ = chunksZ;
+        width = chunkWidth;
+        height = chunkHeight;
+        slots = std::vector<Chunk>(sizeX * sizeY * sizeZ);
+    }
+
+    int SlotCount() const { return static_cast<int>(slots.size()); }
+
+    // SLOT FOR THE CHUNK AT WORLD POSITION (x, y, z) - WHETHER OR NOT IT IS LOADED
+    int SlotIndex(int x, int y, int z) const
+    {
+        int sx = WrapIndex(FloorDiv(x, width),  sizeX);
+        int sy = WrapIndex(FloorDiv(y, height), sizeY);
+        int sz = WrapIndex(FloorDiv(z, width),  sizeZ);
+        return sx + sy * sizeX + sz * sizeX * sizeY;
+    }
+
+    // RETURNS NULL UNLESS THE SLOT CURRENTLY HOLDS THE CHUNK AT (x, y, z)
+    Chunk* Find(int x, int y, int z)
+    {
+        Chunk& chunk = slots[SlotIndex(x, y, z)];
+        if (chunk.loaded && chunk.x == x && chunk.y == y && chunk.z == z) return &chunk;
+        return nullptr;
+    }
+
+private:
+    int width = 1;
+    int height = 1;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef CHUNK_JOB_H
+#define CHUNK_JOB_H
+
+#include "../vendor/glm/glm.hpp"
+#include "../model.h"
+#include "chunk_config.h"
+#include "chunk_classifier.h"
+#include "edit_overlay.h"
+#include "column_cache.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <utility>
+#include <algorithm>
+#include <iostream>
+
+/*
+What moves through the chunk pipeline, shared by every mesher (TerrainGPU, TerrainCPU and SurfaceNetsCPU).
+Nothing here needs an OpenGL context.
+*/
+
+// ONE CHUNK MOVING THROUGH THE GENERATION PIPELINE
+// STAGES: CLASSIFY (WORKER THREAD) -> DENSITY + MESHING (GPU OR WORKER THREADS) -> DECIMATION + PACKED MODEL (WORKER THREAD) -> UPLOAD (MAIN THREAD HANDOFF)
+struct ChunkJob
+{
+    int x;
+    int y;
+    int z;
+    std::atomic<bool> cancelled{false};
+    ChunkContents contents = ChunkContents::Unknown;
+    std::shared_ptr<const EditBrick> edits; // SNAPSHOT TAKEN WHEN THE JOB STARTS, NULL IF UNEDITED
+    std::shared_ptr<ColumnHeights> surface; // SHARED BY EVERY CHUNK IN THE SAME (X, Z) COLUMN
+    std::vector<int> activeBlocks;          // CELL BLOCKS THAT MAY HOLD SURFACE - EMPTY MEANS MESH EVERY BLOCK
+    int lod = 0;            // CELLS ARE 2^LOD CORNERS WIDE
+    int transitionMask = 0; // FACES (-X +X -Y +Y -Z +Z) WHOSE NEIGHBOUR IS ONE LOD COARSER
+    float decimationError = 0.0f; // WORLD UNITS THE MESH MAY BE SIMPLIFIED BY ON THE WORKERS - 0 KEEPS IT AS MESHED
+    std::vector<float> rawVertices;       // MESHER OUTPUT: CHUNK LOCAL POSITION AND NORMAL PER VERTEX, FULL PRECISION UNTIL BuildChunkModel
+    std::vector<unsigned int> rawIndices;
+    Model model;
+};
+
+// ONE FLAG PER CELL ROW (Y, Z) OF THE JOB AT ITS LOD, Y FASTEST - 0 WHEN EVERY CELL BLOCK THE ROW OVERLAPS IS RULED OUT AND THE ROW
+// TOUCHES NO TRANSITION FACE, WHOSE BLENDED SAMPLES THE BOUNDS DON'T COVER (CellActive AND OnTransitionFace IN THE COMPUTE SHADER)
+// ALL 1 FOR A JOB THAT WAS NEVER CLASSIFIED
+inline std::vector<char> ActiveCellRows(const ChunkJob& job, int cellsY, int cellsZ, int stride)
+{
+    using namespace ChunkConfig;
+    std::vector<char> rows(cellsY * cellsZ, 1);
+    if (job.activeBlocks.empty() || (job.transitionMask & 3) != 0) return rows; // X FACES TOUCH EVERY ROW
+
+    for (int z=0; z<cellsZ; ++z) {
+        for (int y=0; y<cellsY; ++y) {
+            if ((y == 0 && (job.transitionMask & 4)) || (y == cellsY - 1 && (job.transitionMask & 8)) ||
+                (z == 0 && (job.transitionMask & 16)) || (z == cellsZ - 1 && (job.transitionMask & 32))) continue;
+
+            int lastY = std::min(((y + 1) * stride - 1) / blockSize, blocksY - 1);
+            int lastZ = std::min(((z + 1) * stride - 1) / blockSize, blocksX - 1);
+            bool active = false;
+            for (int bz = z * stride / blockSize; bz <= lastZ && !active; ++bz) {
+                for (int by = y * stride / blockSize; by <= lastY && !active; ++by) {
+                    const int* blocks = &job.activeBlocks[by * blocksX + bz * blocksX * blocksY];
+                    active = std::any_of(blocks, blocks + blocksX, [](int block) { return block != 0; });
+                }
+            }
+            rows[y + z * cellsY] = active;
+        }
+    }
+    return rows;
+}
+
+struct Chunk 
+{
+    int x;
+    int y;
+    int z;
+    bool loaded = false;
+    ChunkContents contents = ChunkContents::Unknown;
+    bool checked = false;
+    bool regenerate = false;
+    bool retained = false; // OUTSIDE THE LOAD BOX BUT KEPT BY UNLOAD HYSTERESIS
+    int lod = 0;            // LOD AND TRANSITION FACES OF THE CURRENT MESH
+    int transitionMask = 0;
+    float decimationError = 0.0f; // BUDGET THE CURRENT MESH WAS DECIMATED WITH
+    EditOverlay edits;
+    std::shared_ptr<ChunkJob> job; // NULL WHEN THE CHUNK MODEL IS UP TO DATE
+};
+
+// PACKS A MESHER'S RAW OUTPUT INTO THE JOB'S MODEL - THREAD SAFE, RUNS ON THE WORKER POOL
+inline void BuildChunkModel(ChunkJob& job)
+{
+    constexpr int width = ChunkConfig::width;
+    constexpr int height = ChunkConfig::height;
+    constexpr float vertOffsetX = width * -0.5f + 0.5f;
+    constexpr float vertOffsetY = height * -0.5f + 0.5f;
+    constexpr float vertOffsetZ = width * -0.5f + 0.5f;
+
+    // CENTRED POSITIONS, APRON AND LAST CELL LAYER INCLUDED, MUST STAY INSIDE THE PACKED RANGE
+    static_assert(-(std::max(width, height) / 2 + 2) >= VertexPacking::positionOrigin &&
+                  std::max(width, height) / 2 + 2 <= VertexPacking::positionOrigin + VertexPacking::positionExtent,
+                  "chunk does not fit the packed vertex range");
+
+    Model& model = job.model;
+    int vertexCount = static_cast<int>(job.rawVertices.size() / 6);
+    model.vertices.resize(vertexCount);
+    const float* raw = job.rawVertices.data();
+    for (int i=0; i<vertexCount; ++i, raw += 6) {
+        model.vertices[i] = VertexPacking::Pack(raw[0] + vertOffsetX, raw[1] + vertOffsetY, raw[2] + vertOffsetZ, raw[3], raw[4], raw[5]);
+    }
+    model.SetIndices(job.rawIndices);
+    std::vector<float>().swap(job.rawVertices);
+    std::vector<unsigned int>().swap(job.rawIndices);
+
+    model.position = {static_cast<float>(job.x), static_cast<float>(job.y), static_cast<float>(job.z)};
+    model.boundingBox.min = glm::vec3(job.x + width/2, job.y + height/2, job.z + width/2);
+    model.boundingBox.max = glm::vec3(job.x - width/2, job.y - height/2, job.z - width/2);
+    model.boundingBox.isFilled = true;
+}
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef CHUNK_SCHEDULER_H
+#define CHUNK_SCHEDULER_H
+
+#include <vector>
+#include <queue>
+#include "../vendor/glm/glm.hpp"
+#include "../raycast.h"
+
+/*
+Orders missing chunks so the ones the camera can see, nearest first, are generated before anything else.
+Rebuilt every frame from the chunks that are still missing, so it follows teleports and fast turns immediately.
+*/
+
+struct ChunkRequest
+{
+    int x;
+    int y;
+    int z;
+    bool visible;
+    float distanceSq;
+};
+
+struct ChunkRequestPriority
+{
+    // TRUE WHEN A SHOULD BE GENERATED AFTER B
+    bool operator()(const ChunkRequest& a, const ChunkRequest& b) const
+    {
+        if (a.visible != b.visible) return !a.visible;
+        return a.distanceSq > b.distanceSq;
+    }
+};
+
+class ChunkScheduler
+{
+public:
+    int pendingChunks = 0;
+    int pendingVisibleChunks = 0;
+
+    void Begin(const glm::vec3& cameraPosition, const glm::mat4& projectionView)
+    {
+        cameraPos = cameraPosition;
+        planes = ExtractFrustumPlanes(projectionView);
+        queue = std::priority_queue<ChunkRequest, std::vector<ChunkRequest>, ChunkRequestPriority>();
+        pendingChunks = 0;
+        pendingVisibleChunks = 0;
+    }
+
+    void Request(int x, int y, int z, const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+    {
+        ChunkRequest request;
+        request.x = x;
+        request.y = y;
+        request.z = z;
+        request.visible = IsBoxInFrustum(planes, boundsMin, boundsMax);
+        glm::vec3 offset = (boundsMin + boundsMax) * 0.5f - cameraPos;
+        request.distanceSq = glm::dot(offset, offset);
+        queue.push(request);
+
+        pendingChunks += 1;
+        if (request.visible) pendingVisibleChunks += 1;
+    }
+
+    bool Empty() const { return queue.empty(); }
+
+    ChunkRequest Pop()
+    {
+        ChunkRequest request = queue.top();
+        queue.pop();
+        return request;
+    }
+
+private:
+    glm::vec3 cameraPos;
+    std::vector<Plane> planes;
+    std::priority_queue<ChunkRequest, std::vector<ChunkRequest>, ChunkRequestPriority> queue;
+};
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef COLUMN_CACHE_H
+#define COLUMN_CACHE_H
+
+#include <mutex>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include "density_simd.h"
+#include "density_graph.h"
+#include "chunk_coords.h"
+#include "chunk_config.h"
+
+/*
+Surface heights of the vertically stacked chunks sharing an (x, z) column.
+The surface term only depends on x and z, so its five Perlin2D octaves are evaluated once per corner column
+instead of once per 3D corner of every chunk in the column. Classification reads the heights on the workers
+and the compute shader gets them uploaded instead of evaluating the 2D noise itself.
+Heights come from the world's compiled surface graph, or from DensitySIMD's hand written octaves without one.
+*/
+
+// SURFACE HEIGHTS (BEFORE surfaceScale) OF THE cornersX x cornersX CORNER COLUMNS OF ONE CHUNK COLUMN, X FASTEST
+class ColumnHeights
+{
+public:
+    // surface MAY BE NULL AND MUST OUTLIVE THE COLUMN
+    ColumnHeights(int x, int z, const DensityKernel* surface) : x(x), z(z), surface(surface) {}
+
+    int X() const { return x; }
+    int Z() const { return z; }
+
+    // COMPUTED BY WHICHEVER THREAD ASKS FIRST - WORKERS CLASSIFYING THE COLUMN'S CHUNKS OR THE GPU DISPATCH
+    const float* Values()
+    {
+        std::call_once(computed, [this] {
+            using namespace ChunkConfig;
+            std::vector<float> xs(cornersX * cornersX), zs(cornersX * cornersX);
+            for (int i=0; i<cornersX * cornersX; ++i) {
+                xs[i] = static_cast<float>(x + i % cornersX);
+                zs[i] = static_cast<float>(z + i / cornersX);
+            }
+            values.resize(cornersX * cornersX);
+            if (surface)
+            {
+                std::vector<float> unused(cornersX * cornersX, 0.0f);
+                surface->Evaluate(xs.data(), unused.data(), zs.data(), unused.data(), values.data(), cornersX * cornersX);
+            }
+            else DensitySIMD::SurfaceHeights(xs.data(), zs.data(), values.data(), cornersX * cornersX);
+        });
+        return values.data();
+    }
+
+private:
+    int x, z;
+    const DensityKernel* surface;
+    std::once_flag computed;
+    std::vector<float> values;
+};
+
+// MAIN THREAD ONLY - JOBS KEEP THEIR COLUMN ALIVE THROUGH THEIR OWN REFERENCE
+class ColumnCache
+{
+public:
+    int columnsCreated = 0; // EACH IS ONE EVALUATION OF THE 2D NOISE FOR A WHOLE COLUMN OF CHUNKS
+    const DensityKernel* surface = nullptr; // COMPILED SURFACE GRAPH - NULL FOR THE HAND WRITTEN DEFAULT
+
+    int Count() const { return static_cast<int>(columns.size()); }
+
+    std::shared_ptr<ColumnHeights> Acquire(int x, int z)
+    {
+        std::shared_ptr<ColumnHeights>& column = columns[PackCoords(x, 0, z)];
+        if (!column)
+        {
+            column = std::make_shared<ColumnHeights>(x, z, surface);
+            columnsCreated += 1;
+        }
+        return column;
+    }
+
+    // EVICTS EVERY COLUMN WHOSE CHUNKS HAVE ALL LEFT THE (x, z) RANGE
+    void EvictOutside(int minX, int maxX, int minZ, int maxZ)
+    {
+        for (auto it = columns.begin(); it != columns.end();)
+        {
+            int x = it->second->X();
+            int z = it->second->Z();
+            if (x < minX || x > maxX || z < minZ || z > maxZ) it = columns.erase(it);
+            else ++it;
+        }
+    }
+
+private:
+    std::unordered_map<uint64_t, std::shared_ptr<ColumnHeights>> columns;
+};
+
+#endif
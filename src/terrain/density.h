@@ -0,0 +1,239 @@
+#ifndef DENSITY_H
+#define DENSITY_H
+
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+/*
+CPU side of the terrain density function in shaders/marching_cubes.compute.
+Functions mirror the shader one to one (same hash, same interpolation, same octaves) so CPU results
+can stand in for the GPU ones. GPU sin/cos are not bit exact, so values agree to within a small tolerance.
+*/
+
+namespace Density
+{
+    // MUST MATCH GetDensity IN THE COMPUTE SHADER
+    const float surfaceScale = 1.5f;
+    const float caveScale = 0.85f;
+    const float blendDistance = 6.0f;
+
+    // RANGE OF ONE Perlin3D OCTAVE: (v + 1) / 2 WITH |v| <= sqrt(3) / 2 FOR UNIT GRADIENTS
+    const float perlin3DMin = 0.5f - 0.4330128f;
+    const float perlin3DMax = 0.5f + 0.4330128f;
+
+    // RANGE OF GetCaveDensity * caveScale - OCTAVE WEIGHTS 1 + 0.5 + 0.25 + 0.15
+    const float caveMin = perlin3DMin * 1.9f * caveScale;
+    const float caveMax = perlin3DMax * 1.9f * caveScale;
+
+    // SLACK FOR CPU / GPU SIN AND COS DIFFERENCES WHEN BOUNDS DECIDE WHAT THE GPU WOULD PRODUCE
+    const float boundsTolerance = 0.01f;
+
+    inline void RandomGradient2D(int ix, int iy, float& gx, float& gy)
+    {
+        const uint32_t w = 32u;
+        const uint32_t s = w / 2;
+
+        uint32_t a = static_cast<uint32_t>(ix), b = static_cast<uint32_t>(iy);
+        a *= 3284157443U;
+        b ^= a << s | a >> (w - s);
+        b *= 1911520717U;
+        a ^= b << s | b >> (w - s);
+        a *= 2048419325U;
+        float random = static_cast<float>(a) * (3.14159265f / 4294967296.0f); // in [0, 2*Pi]
+
+        gx = std::sin(random);
+        gy = std::cos(random);
+    }
+
+    inline void RandomGradient3D(int ix, int iy, int iz, float& gx, float& gy, float& gz)
+    {
+        const uint32_t w = 32u;
+        const uint32_t s = w / 2;
+
+        uint32_t a = static_cast<uint32_t>(ix), b = static_cast<uint32_t>(iy), c = static_cast<uint32_t>(iz);
+        a *= 3284157443U;
+        b ^= a << s | a >> (w - s);
+        b *= 1911520717U;
+        a ^= b << s | b >> (w - s);
+        a *= 2048419325U;
+        float randomX = static_cast<float>(a) * (3.14159265f / 4294967296.0f);
+
+        c *= 3329032859U;
+        c ^= a << s | a >> (w - s);
+        c *= 1431691223U;
+        b ^= c << s | c >> (w - s);
+        b *= 1812433253U;
+        float randomZ = static_cast<float>(b) * (3.14159265f / 4294967296.0f);
+
+        gx = std::sin(randomX) * std::cos(randomZ);
+        gy = std::cos(randomX) * std::cos(randomZ);
+        gz = std::sin(randomZ);
+    }
+
+    inline float DotGridGradient3D(int ix, int iy, int iz, float x, float y, float z)
+    {
+        float gx, gy, gz;
+        RandomGradient3D(ix, iy, iz, gx, gy, gz);
+        return gx * (x - static_cast<float>(ix)) + gy * (y - static_cast<float>(iy)) + gz * (z - static_cast<float>(iz));
+    }
+
+    inline float DotGridGradient2D(int ix, int iy, float x, float y)
+    {
+        float gx, gy;
+        RandomGradient2D(ix, iy, gx, gy);
+        return gx * (x - static_cast<float>(ix)) + gy * (y - static_cast<float>(iy));
+    }
+
+    inline float Interpolate(float a0, float a1, float w)
+    {
+        return (a1 - a0) * (3.0f - w * 2.0f) * w * w + a0;
+    }
+
+    inline float Perlin2D(float x, float y)
+    {
+        // Grid corner coordinates
+        int x0 = static_cast<int>(std::floor(x));
+        int y0 = static_cast<int>(std::floor(y));
+        int x1 = x0 + 1;
+        int y1 = y0 + 1;
+
+        // Interpolation weights
+        float sx = x - static_cast<float>(x0);
+        float sy = y - static_cast<float>(y0);
+
+        // Corners
+        float n0 = DotGridGradient2D(x0, y0, x, y);
+        float n1 = DotGridGradient2D(x1, y0, x, y);
+        float n2 = DotGridGradient2D(x0, y1, x, y);
+        float n3 = DotGridGradient2D(x1, y1, x, y);
+
+        // Interpolation
+        float ix0 = Interpolate(n0, n1, sx);
+        float ix1 = Interpolate(n2, n3, sx);
+        return Interpolate(ix0, ix1, sy);
+    }
+
+    // IN [0, 1] - SHIFTED AND SCALED LIKE THE SHADER
+    inline float Perlin3D(float x, float y, float z)
+    {
+        // Grid cell corner coordinates
+        int x0 = static_cast<int>(std::floor(x));
+        int y0 = static_cast<int>(std::floor(y));
+        int z0 = static_cast<int>(std::floor(z));
+        int x1 = x0 + 1;
+        int y1 = y0 + 1;
+        int z1 = z0 + 1;
+
+        // Interpolation weights
+        float sx = x - static_cast<float>(x0);
+        float sy = y - static_cast<float>(y0);
+        float sz = z - static_cast<float>(z0);
+
+        // Bottom corners
+        float n0 = DotGridGradient3D(x0, y0, z0, x, y, z);
+        float n1 = DotGridGradient3D(x1, y0, z0, x, y, z);
+        float n2 = DotGridGradient3D(x0, y1, z0, x, y, z);
+        float n3 = DotGridGradient3D(x1, y1, z0, x, y, z);
+
+        // Top corners
+        float n4 = DotGridGradient3D(x0, y0, z1, x, y, z);
+        float n5 = DotGridGradient3D(x1, y0, z1, x, y, z);
+        float n6 = DotGridGradient3D(x0, y1, z1, x, y, z);
+        float n7 = DotGridGradient3D(x1, y1, z1, x, y, z);
+
+        // Trilinear interpolation
+        float ix0 = Interpolate(n0, n1, sx);
+        float ix1 = Interpolate(n2, n3, sx);
+        float ix2 = Interpolate(n4, n5, sx);
+        float ix3 = Interpolate(n6, n7, sx);
+
+        float iy0 = Interpolate(ix0, ix1, sy);
+        float iy1 = Interpolate(ix2, ix3, sy);
+
+        return (Interpolate(iy0, iy1, sz) + 1.0f) / 2.0f;
+    }
+
+    // WORLD SPACE SURFACE HEIGHT BEFORE surfaceScale IS APPLIED - THE SHADER GETS IT PER COLUMN FROM ColumnHeights
+    inline float GetSurfaceHeight(float x, float z)
+    {
+        return (Perlin2D(x * 0.005f, z * 0.005f) * 40) +
+        (Perlin2D(x * 0.01f, z * 0.01f) * 20) +
+        (Perlin2D(x * 0.02f, z * 0.02f) * 10) +
+        (Perlin2D(x * 0.04f, z * 0.04f) * 5) +
+        (Perlin2D(x * 0.08f, z * 0.08f) * 2.5f);
+    }
+
+    // WORLD SPACE CAVE TERM BEFORE caveScale IS APPLIED
+    inline float GetCaveDensity(float x, float y, float z)
+    {
+        float sx = x * 0.05f;
+        float sy = y * 0.05f;
+        float sz = z * 0.05f;
+        return Perlin3D(sx, sy, sz)
+        + Perlin3D(sx * 2, sy * 2, sz * 2) * 0.5f
+        + Perlin3D(sx * 4, sy * 4, sz * 4) * 0.25f
+        + Perlin3D(sx * 8, sy * 8, sz * 8) * 0.15f;
+    }
+
+    // PROCEDURAL DENSITY AT A WORLD SPACE CORNER, WITHOUT EDITS, WITH THE CAVE TERM FROM cave(x, y, z)
+    // surfaceHeight IS GetSurfaceHeight(x, z) - PASSED IN SO A COLUMN OF CORNERS EVALUATES IT ONCE
+    template <typename CaveFunction>
+    inline float GetDensity(float x, float y, float z, float surfaceHeight, CaveFunction cave)
+    {
+        float scaledSurface = surfaceHeight * surfaceScale;
+        float surfaceDensity = std::clamp(scaledSurface - y, 0.0f, 1.0f);
+
+        // THE CAVE TERM IS FULLY BLENDED OUT ABOVE THE BLEND BAND
+        if (y >= scaledSurface + blendDistance) return surfaceDensity;
+
+        float caveDensity = cave(x, y, z) * caveScale;
+        float blendTerm = std::clamp((scaledSurface + blendDistance - y) / blendDistance, 0.0f, 1.0f);
+        return surfaceDensity + (caveDensity - surfaceDensity) * blendTerm;
+    }
+
+    inline float GetDensity(float x, float y, float z, float surfaceHeight)
+    {
+        return GetDensity(x, y, z, surfaceHeight, GetCaveDensity);
+    }
+
+    inline float GetDensity(float x, float y, float z)
+    {
+        return GetDensity(x, y, z, GetSurfaceHeight(x, z));
+    }
+
+    struct Interval
+    {
+        float min;
+        float max;
+    };
+
+    // CONSERVATIVE RANGE OF GetDensity FOR EVERY POINT WHOSE SCALED SURFACE HEIGHT, HEIGHT AND CAVE TERM LIE IN THE GIVEN RANGES
+    // density = mix(clamp(s - y, 0, 1), cave, clamp((s + blend - y) / blend, 0, 1)) IS MULTILINEAR IN (surfaceDensity, cave, blend)
+    // SO ITS EXTREMES OVER THE BOX LIE ON THE BOX CORNERS
+    inline Interval DensityBounds(Interval surface, Interval height, Interval cave)
+    {
+        float dLo = surface.min - height.max;
+        float dHi = surface.max - height.min;
+        float sd[2] = { std::clamp(dLo, 0.0f, 1.0f), std::clamp(dHi, 0.0f, 1.0f) };
+        float t[2]  = { std::clamp((dLo + blendDistance) / blendDistance, 0.0f, 1.0f),
+                        std::clamp((dHi + blendDistance) / blendDistance, 0.0f, 1.0f) };
+        float c[2]  = { cave.min, cave.max };
+
+        Interval result = { 1e30f, -1e30f };
+        for (int i=0; i<8; ++i)
+        {
+            float a = sd[i & 1];
+            float b = c[(i >> 1) & 1];
+            float w = t[(i >> 2) & 1];
+            float density = a + (b - a) * w;
+            result.min = std::min(result.min, density);
+            result.max = std::max(result.max, density);
+        }
+        result.min -= boundsTolerance;
+        result.max += boundsTolerance;
+        return result;
+    }
+}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef DENSITY_BOUNDS_H
+#define DENSITY_BOUNDS_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "density.h"
+#include "density_simd.h"
+#include "edit_overlay.h"
+#include "chunk_config.h"
+
+/*
+Conservative [min, max] of the density over an axis aligned box, without sampling it.
+Each Perlin3D octave is bounded lattice cell by lattice cell: the corner terms g . (p - c) are linear in p so their
+range over the box is exact, and the smoothstep weights are monotonic so the interpolations are bounded by their
+end weights. The surface comes from the column heights and the two are combined with Density::DensityBounds.
+*/
+
+namespace Density
+{
+    // OCTAVES SPANNING MORE LATTICE CELLS THAN THIS PER AXIS FALL BACK TO THE GLOBAL PERLIN RANGE
+    const int maxBoundCells = 8;
+
+    inline Interval Lerp(Interval a0, Interval a1, Interval w)
+    {
+        float lo = std::min(a0.min + (a1.min - a0.min) * w.min, a0.min + (a1.min - a0.min) * w.max);
+        float hi = std::max(a0.max + (a1.max - a0.max) * w.min, a0.max + (a1.max - a0.max) * w.max);
+        return { lo, hi };
+    }
+
+    inline float Smoothstep(float w)
+    {
+        return (3.0f - w * 2.0f) * w * w;
+    }
+
+    using DensitySIMD::GradientLattice;
+
+    // RANGE OF Perlin3D OVER THE NOISE SPACE BOX [lo, hi], WHICH MUST LIE INSIDE THE BOX THE LATTICE WAS BUILT FOR
+    inline Interval Perlin3DBounds(const GradientLattice& lattice, const float lo[3], const float hi[3])
+    {
+        if (lattice.global) return { perlin3DMin, perlin3DMax };
+
+        int cellMin[3], cellMax[3];
+        for (int axis=0; axis<3; ++axis) {
+            cellMin[axis] = static_cast<int>(std::floor(lo[axis]));
+            cellMax[axis] = std::max(cellMin[axis], static_cast<int>(std::ceil(hi[axis])) - 1);
+        }
+
+        Interval result = { 1e30f, -1e30f };
+        for (int cz = cellMin[2]; cz <= cellMax[2]; ++cz)
+            for (int cy = cellMin[1]; cy <= cellMax[1]; ++cy)
+                for (int cx = cellMin[0]; cx <= cellMax[0]; ++cx)
+                {
+                    // THE PART OF THE BOX INSIDE THIS LATTICE CELL, AS OFFSETS FROM ITS LOW CORNER
+                    int cell[3] = { cx, cy, cz };
+                    float sLo[3], sHi[3];
+                    Interval weights[3];
+                    for (int axis=0; axis<3; ++axis) {
+                        sLo[axis] = std::clamp(lo[axis] - cell[axis], 0.0f, 1.0f);
+                        sHi[axis] = std::clamp(hi[axis] - cell[axis], 0.0f, 1.0f);
+                        weights[axis] = { Smoothstep(sLo[axis]), Smoothstep(sHi[axis]) };
+                    }
+
+                    // CORNER TERMS g . (p - c) - LINEAR IN p SO EACH COMPONENT TAKES ITS EXTREME AT A BOX FACE
+                    Interval corners[8];
+                    for (int i=0; i<8; ++i) {
+                        int offset[3] = { i & 1, (i >> 1) & 1, (i >> 2) & 1 };
+                        int point = lattice.Index(cx - lattice.origin[0] + offset[0], cy - lattice.origin[1] + offset[1], cz - lattice.origin[2] + offset[2]);
+                        const float* g = &lattice.gradients[point * 3];
+                        corners[i] = { 0.0f, 0.0f };
+                        for (int axis=0; axis<3; ++axis) {
+                            float a = g[axis] * (sLo[axis] - offset[axis]);
+                            float b = g[axis] * (sHi[axis] - offset[axis]);
+                            corners[i].min += std::min(a, b);
+                            corners[i].max += std::max(a, b);
+                        }
+                    }
+
+                    Interval y0 = Lerp(Lerp(corners[0], corners[1], weights[0]), Lerp(corners[2], corners[3], weights[0]), weights[1]);
+                    Interval y1 = Lerp(Lerp(corners[4], corners[5], weights[0]), Lerp(corners[6], corners[7], weights[0]), weights[1]);
+                    Interval value = Lerp(y0, y1, weights[2]);
+                    result.min = std::min(result.min, (value.min + 1.0f) / 2.0f);
+                    result.max = std::max(result.max, (value.max + 1.0f) / 2.0f);
+                }
+
+        result.min = std::max(result.min, perlin3DMin);
+        result.max = std::min(result.max, perlin3DMax);
+        return result;
+    }
+
+    /*
+    Density bounds for boxes of corners inside one chunk.
+    The cave octaves' lattice gradients (the only expensive part) are built once for the whole chunk, and only
+    if some box reaches down into the blend band.
+    */
+    class ChunkBounds
+    {
+    public:
+        // surfaceHeights ARE THE CHUNK'S ColumnHeights, EDITS MAY BE NULL
+        ChunkBounds(const float* surfaceHeights, int chunkX, int chunkY, int chunkZ, const EditBrick* edits)
+            : surfaceHeights(surfaceHeights), chunk{ chunkX, chunkY, chunkZ }, edits(edits)
+        {
+            if (edits) editRange = edits->Range();
+        }
+
+        // RANGE OF THE DENSITY OVER THE CORNERS [c0, c1] (LOCAL, INCLUSIVE)
+        Interval Box(const int c0[3], const int c1[3])
+        {
+            Interval surface = { 1e30f, -1e30f };
+            for (int z = c0[2]; z <= c1[2]; ++z) {
+                for (int x = c0[0]; x <= c1[0]; ++x) {
+                    float surfaceHeight = surfaceHeights[x + z * ChunkConfig::cornersX] * surfaceScale;
+                    surface.min = std::min(surface.min, surfaceHeight);
+                    surface.max = std::max(surface.max, surfaceHeight);
+                }
+            }
+
+            float lo[3], hi[3];
+            for (int axis=0; axis<3; ++axis) {
+                lo[axis] = static_cast<float>(chunk[axis] + c0[axis]);
+                hi[axis] = static_cast<float>(chunk[axis] + c1[axis]);
+            }
+            Interval pointHeight = { lo[1], hi[1] };
+
+            // THE CAVE TERM IS FULLY BLENDED OUT ABOVE THE BLEND BAND - DON'T BOUND IT THERE
+            Interval cave = { 0.0f, 0.0f };
+            if (pointHeight.min < surface.max + blendDistance) cave = CaveBounds(lo, hi);
+
+            Interval density = DensityBounds(surface, pointHeight, cave);
+
+            // EDITS ONLY WIDEN THE BOUNDS WHERE THE BRICK OVERLAPS THE BOX
+            if (edits)
+            {
+                bool overlaps = true;
+                int brickMin[3] = { edits->minX, edits->minY, edits->minZ };
+                int brickSize[3] = { edits->sizeX, edits->sizeY, edits->sizeZ };
+                for (int axis=0; axis<3; ++axis) {
+                    if (c1[axis] < brickMin[axis] || c0[axis] >= brickMin[axis] + brickSize[axis]) overlaps = false;
+                }
+                if (overlaps)
+                {
+                    density.min += editRange.min;
+                    density.max += editRange.max;
+                }
+            }
+            return density;
+        }
+
+    private:
+        const float* surfaceHeights;
+        int chunk[3];
+        const EditBrick* edits;
+        Interval editRange = { 0.0f, 0.0f };
+        bool latticesBuilt = false;
+        GradientLattice lattices[4];
+
+        // RANGE OF GetCaveDensity * caveScale OVER THE WORLD SPACE BOX [lo, hi]
+        Interval CaveBounds(const float lo[3], const float hi[3])
+        {
+            const float weights[4] = { 1.0f, 0.5f, 0.25f, 0.15f };
+            if (!latticesBuilt)
+            {
+                for (int octave=0; octave<4; ++octave) {
+                    float frequency = 0.05f * (1 << octave);
+                    float chunkLo[3], chunkHi[3];
+                    for (int axis=0; axis<3; ++axis) {
+                        int size = axis == 1 ? ChunkConfig::height : ChunkConfig::width;
+                        chunkLo[axis] = chunk[axis] * frequency;
+                        chunkHi[axis] = (chunk[axis] + size) * frequency;
+                    }
+                    lattices[octave].Build(chunkLo, chunkHi, maxBoundCells);
+                }
+                latticesBuilt = true;
+            }
+
+            Interval cave = { 0.0f, 0.0f };
+            for (int octave=0; octave<4; ++octave)
+            {
+                float frequency = 0.05f * (1 << octave);
+                float noiseLo[3] = { lo[0] * frequency, lo[1] * frequency, lo[2] * frequency };
+                float noiseHi[3] = { hi[0] * frequency, hi[1] * frequency, hi[2] * frequency };
+                Interval noise = Perlin3DBounds(lattices[octave], noiseLo, noiseHi);
+                cave.min += noise.min * weights[octave];
+                cave.max += noise.max * weights[octave];
+            }
+            return { cave.min * caveScale, cave.max * caveScale };
+        }
+    };
+}
+
+#endif
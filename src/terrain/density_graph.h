@@ -0,0 +1,731 @@
+#ifndef DENSITY_GRAPH_H
+#define DENSITY_GRAPH_H
+
+#include <map>
+#include <tuple>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include "density.h"
+#include "density_simd.h"
+#include "noise_backends.h"
+
+/*
+Terrain shapes described as a graph of density nodes instead of hand written functions.
+A graph is built from noise, arithmetic, clamp, blend and CSG nodes and then optimized: constants are folded,
+identical nodes are shared and weighted sums of noise octaves are fused into single fBm nodes. The optimized
+graph is compiled twice - into a DensityKernel that runs each node over a batch of points with the SIMD noise,
+and into a GLSL function the compute shader calls in place of its own density function.
+Evaluate() interprets the graph as built, one point at a time, and is the reference both are checked against.
+*/
+
+enum class DensityOp
+{
+    Constant,
+    X, Y, Z,   // WORLD SPACE SAMPLE POSITION
+    Surface,   // SURFACE HEIGHT (BEFORE surfaceScale) OF THE SAMPLE'S COLUMN - DENSITY GRAPHS ONLY
+    FBm2D,     // value * SUM OF weight * Perlin2D(x * frequency, z * frequency)
+    FBm3D,     // value * SUM OF weight * noise(x * frequency, y * frequency, z * frequency) FROM THE NODE'S BACKEND
+    Add, Sub, Mul, Div,
+    Min, Max,
+    Clamp,     // clamp(a, b, c)
+    Mix        // a + (b - a) * c - b IS ONLY EVALUATED WHERE c != 0
+};
+
+struct NoiseOctave
+{
+    float frequency;
+    float weight;
+
+    bool operator<(const NoiseOctave& other) const
+    {
+        return std::tie(frequency, weight) < std::tie(other.frequency, other.weight);
+    }
+};
+
+struct DensityNode
+{
+    DensityOp op;
+    int inputs[3] = { -1, -1, -1 };
+    float value = 0.0f; // THE CONSTANT, OR THE SCALE OF AN FBM NODE
+    std::vector<NoiseOctave> octaves = {};
+    NoiseBackend noise = NoiseBackend::Hash; // FBm3D ONLY
+};
+
+class DensityGraph
+{
+public:
+    int root = -1;
+
+    const std::vector<DensityNode>& Nodes() const { return nodes; }
+    int NodeCount() const { return static_cast<int>(nodes.size()); }
+
+    // BUILDING - EVERY METHOD RETURNS THE INDEX OF THE NODE IT ADDS
+    int Constant(float value)
+    {
+        DensityNode node = { DensityOp::Constant };
+        node.value = value;
+        return Push(node);
+    }
+    int X() { return Push({ DensityOp::X }); }
+    int Y() { return Push({ DensityOp::Y }); }
+    int Z() { return Push({ DensityOp::Z }); }
+    int Surface() { return Push({ DensityOp::Surface }); }
+
+    // ONE OCTAVE OF NOISE IN [0, 1]
+    int Noise2D(float frequency) { return Push(Noise(DensityOp::FBm2D, { { frequency, 1.0f } })); }
+    int Noise3D(float frequency, NoiseBackend backend = NoiseBackend::Hash)
+    {
+        DensityNode node = Noise(DensityOp::FBm3D, { { frequency, 1.0f } });
+        node.noise = backend;
+        return Push(node);
+    }
+
+    // WEIGHTED OCTAVES ADDED UP NODE BY NODE - Optimize() FUSES THEM BACK INTO ONE NODE
+    int FBm2D(const std::vector<NoiseOctave>& octaves) { return WeightedSum(octaves, false, NoiseBackend::Hash); }
+    int FBm3D(const std::vector<NoiseOctave>& octaves, NoiseBackend backend = NoiseBackend::Hash) { return WeightedSum(octaves, true, backend); }
+
+    int Add(int a, int b) { return Push(Binary(DensityOp::Add, a, b)); }
+    int Sub(int a, int b) { return Push(Binary(DensityOp::Sub, a, b)); }
+    int Mul(int a, int b) { return Push(Binary(DensityOp::Mul, a, b)); }
+    int Div(int a, int b) { return Push(Binary(DensityOp::Div, a, b)); }
+    int Min(int a, int b) { return Push(Binary(DensityOp::Min, a, b)); }
+    int Max(int a, int b) { return Push(Binary(DensityOp::Max, a, b)); }
+    int Offset(int a, float amount) { return Add(a, Constant(amount)); }
+    int Scale(int a, float factor) { return Mul(a, Constant(factor)); }
+
+    int Clamp(int a, float lo, float hi)
+    {
+        DensityNode node = Binary(DensityOp::Clamp, a, Constant(lo));
+        node.inputs[2] = Constant(hi);
+        return Push(node);
+    }
+
+    // a WHERE t IS 0, b WHERE t IS 1
+    int Mix(int a, int b, int t)
+    {
+        DensityNode node = Binary(DensityOp::Mix, a, b);
+        node.inputs[2] = t;
+        return Push(node);
+    }
+
+    // (height - y) / distance - GROWS BY 1 EVERY distance BELOW height
+    int HeightGradient(int height, float distance) { return Div(Sub(height, Y()), Constant(distance)); }
+
+    // CSG ON DENSITIES THAT ARE SOLID ABOVE threshold
+    int Union(int a, int b) { return Max(a, b); }
+    int Intersect(int a, int b) { return Min(a, b); }
+    int Difference(int a, int b, float threshold) { return Min(a, Sub(Constant(2.0f * threshold), b)); }
+
+    // FOLDED, DEDUPLICATED AND FUSED COPY HOLDING ONLY THE NODES THE ROOT USES
+    DensityGraph Optimize() const
+    {
+        DensityGraph optimized = *this;
+        // THE SECOND PASS DROPS NODES THAT A LATER FUSION LEFT UNUSED
+        for (int pass=0; pass<2; ++pass)
+        {
+            DensityGraph rebuilt;
+            std::vector<int> remap(optimized.nodes.size(), -1);
+            std::map<NodeKey, int> existing;
+            rebuilt.root = rebuilt.Rebuild(optimized, optimized.root, remap, existing);
+            optimized = rebuilt;
+        }
+        return optimized;
+    }
+
+    // INTERPRETER - WALKS THE GRAPH FOR ONE POINT WITH THE SCALAR NOISE
+    float Evaluate(float x, float y, float z, float surfaceHeight) const
+    {
+        thread_local std::vector<float> values;
+        thread_local std::vector<char> done;
+        values.assign(nodes.size(), 0.0f);
+        done.assign(nodes.size(), 0);
+        const float position[4] = { x, y, z, surfaceHeight };
+        return EvaluateNode(root, position, values, done);
+    }
+
+    // NODES IN EVALUATION ORDER, INPUTS FIRST - A BLEND WEIGHT COMES BEFORE EVERYTHING ONLY ITS b INPUT NEEDS
+    std::vector<int> Schedule() const
+    {
+        std::vector<int> order;
+        std::vector<char> visited(nodes.size(), 0);
+        ScheduleNode(root, visited, order);
+        return order;
+    }
+
+    // PER NODE THE INNERMOST Mix WHOSE b INPUT IS THE ONLY WAY THE ROOT REACHES IT, -1 FOR NODES ALWAYS NEEDED
+    // SUCH NODES ARE SKIPPED WHEREVER THAT Mix'S BLEND WEIGHT IS 0
+    std::vector<int> BlendGuards() const
+    {
+        std::vector<int> guards(nodes.size(), -1);
+        std::vector<int> order = Schedule();
+
+        // OUTER BLENDS FIRST SO NESTED ONES OVERWRITE THEM
+        for (auto it = order.rbegin(); it != order.rend(); ++it)
+        {
+            int mix = *it;
+            if (nodes[mix].op != DensityOp::Mix) continue;
+            std::vector<char> outside(nodes.size(), 0), inside(nodes.size(), 0);
+            Mark(root, mix, outside);
+            Mark(nodes[mix].inputs[1], -1, inside);
+            for (int node=0; node<NodeCount(); ++node) {
+                if (inside[node] && !outside[node]) guards[node] = mix;
+            }
+        }
+        return guards;
+    }
+
+    // float name(float x, float y, float z, float surfaceHeight) - CALLS THE SHADER'S 3D NOISE FUNCTIONS
+    std::string EmitGLSL(const std::string& name) const
+    {
+        std::vector<int> guards = BlendGuards();
+        std::vector<char> emitted(nodes.size(), 0);
+        std::string body;
+        EmitNode(root, guards, emitted, body, "    ");
+        return "float " + name + "(float x, float y, float z, float surfaceHeight)\n{\n" + body + "    return " + Ref(root) + ";\n}\n";
+    }
+
+    static float Apply(DensityOp op, float a, float b, float c)
+    {
+        switch (op)
+        {
+            case DensityOp::Add:   return a + b;
+            case DensityOp::Sub:   return a - b;
+            case DensityOp::Mul:   return a * b;
+            case DensityOp::Div:   return a / b;
+            case DensityOp::Min:   return std::min(a, b);
+            case DensityOp::Max:   return std::max(a, b);
+            case DensityOp::Clamp: return std::min(std::max(a, b), c);
+            case DensityOp::Mix:   return a + (b - a) * c;
+            default:               return 0.0f;
+        }
+    }
+
+    static bool IsNoise(DensityOp op) { return op == DensityOp::FBm2D || op == DensityOp::FBm3D; }
+    static bool IsInput(DensityOp op) { return op == DensityOp::X || op == DensityOp::Y || op == DensityOp::Z || op == DensityOp::Surface; }
+
+private:
+    std::vector<DensityNode> nodes;
+
+    using NodeKey = std::tuple<int, int, int, int, float, std::vector<NoiseOctave>, int>;
+
+    int Push(const DensityNode& node)
+    {
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    static DensityNode Noise(DensityOp op, std::vector<NoiseOctave> octaves)
+    {
+        DensityNode node = { op };
+        node.value = 1.0f;
+        node.octaves = octaves;
+        return node;
+    }
+
+    static DensityNode Binary(DensityOp op, int a, int b)
+    {
+        DensityNode node = { op };
+        node.inputs[0] = a;
+        node.inputs[1] = b;
+        return node;
+    }
+
+    int WeightedSum(const std::vector<NoiseOctave>& octaves, bool threeD, NoiseBackend backend)
+    {
+        int sum = -1;
+        for (const NoiseOctave& octave : octaves) {
+            int noise = threeD ? Noise3D(octave.frequency, backend) : Noise2D(octave.frequency);
+            int term = octave.weight == 1.0f ? noise : Scale(noise, octave.weight);
+            sum = sum < 0 ? term : Add(sum, term);
+        }
+        return sum < 0 ? Constant(0.0f) : sum;
+    }
+
+    bool IsConstant(int node) const { return node >= 0 && nodes[node].op == DensityOp::Constant; }
+    bool IsConstant(int node, float value) const { return IsConstant(node) && nodes[node].value == value; }
+
+    int Rebuild(const DensityGraph& source, int node, std::vector<int>& remap, std::map<NodeKey, int>& existing)
+    {
+        if (remap[node] >= 0) return remap[node];
+        DensityNode copy = source.nodes[node];
+        for (int& input : copy.inputs) {
+            if (input >= 0) input = Rebuild(source, input, remap, existing);
+        }
+        remap[node] = Intern(copy, existing);
+        return remap[node];
+    }
+
+    // ADDS A NODE WHOSE INPUTS ARE ALREADY IN THIS GRAPH, SIMPLIFYING IT OR REUSING AN IDENTICAL NODE WHERE IT CAN
+    // EVERY REWRITE GIVES BIT IDENTICAL RESULTS FOR WEIGHTED OCTAVE SUMS BUILT LEFT TO RIGHT, LIKE FBm2D / FBm3D BUILD THEM
+    int Intern(DensityNode node, std::map<NodeKey, int>& existing)
+    {
+        DensityOp op = node.op;
+        int* in = node.inputs;
+        bool arithmetic = op >= DensityOp::Add;
+
+        // CONSTANT FOLDING
+        if (arithmetic && IsConstant(in[0]) && IsConstant(in[1]) && (in[2] < 0 || IsConstant(in[2])))
+        {
+            float c = in[2] < 0 ? 0.0f : nodes[in[2]].value;
+            DensityNode folded = { DensityOp::Constant };
+            folded.value = Apply(op, nodes[in[0]].value, nodes[in[1]].value, c);
+            return Intern(folded, existing);
+        }
+
+        // CONSTANTS AND NON-NOISE OPERANDS SECOND
+        bool commutative = op == DensityOp::Add || op == DensityOp::Mul || op == DensityOp::Min || op == DensityOp::Max;
+        if (commutative && ((IsConstant(in[0]) && !IsConstant(in[1])) || (!IsNoise(nodes[in[0]].op) && IsNoise(nodes[in[1]].op)))) std::swap(in[0], in[1]);
+
+        // IDENTITIES
+        if ((op == DensityOp::Add || op == DensityOp::Sub) && IsConstant(in[1], 0.0f)) return in[0];
+        if ((op == DensityOp::Mul || op == DensityOp::Div) && IsConstant(in[1], 1.0f)) return in[0];
+        if ((op == DensityOp::Min || op == DensityOp::Max) && in[0] == in[1]) return in[0];
+        if (op == DensityOp::Mix && (IsConstant(in[2], 0.0f) || in[0] == in[1])) return in[0];
+        if (op == DensityOp::Mix && IsConstant(in[2], 1.0f)) return in[1];
+
+        // FUSION - WEIGHTS AND SCALES MOVE INTO FBM NODES, SUMS OF FBM NODES BECOME ONE NODE
+        if (op == DensityOp::Mul && IsNoise(nodes[in[0]].op) && nodes[in[0]].value == 1.0f && IsConstant(in[1]))
+        {
+            DensityNode fused = nodes[in[0]];
+            float factor = nodes[in[1]].value;
+            if (fused.octaves.size() == 1) fused.octaves[0].weight *= factor;
+            else fused.value = factor;
+            return Intern(fused, existing);
+        }
+        if (op == DensityOp::Add && IsNoise(nodes[in[0]].op) && nodes[in[0]].op == nodes[in[1]].op &&
+            nodes[in[0]].noise == nodes[in[1]].noise && nodes[in[0]].value == 1.0f && nodes[in[1]].value == 1.0f)
+        {
+            DensityNode fused = nodes[in[0]];
+            fused.octaves.insert(fused.octaves.end(), nodes[in[1]].octaves.begin(), nodes[in[1]].octaves.end());
+            return Intern(fused, existing);
+        }
+
+        // COMMON SUBEXPRESSIONS
+        NodeKey key = { static_cast<int>(op), in[0], in[1], in[2], node.value, node.octaves, static_cast<int>(node.noise) };
+        auto found = existing.find(key);
+        if (found != existing.end()) return found->second;
+        int index = Push(node);
+        existing[key] = index;
+        return index;
+    }
+
+    float EvaluateNode(int index, const float position[4], std::vector<float>& values, std::vector<char>& done) const
+    {
+        if (done[index]) return values[index];
+        const DensityNode& node = nodes[index];
+        const int* in = node.inputs;
+        float result = 0.0f;
+        switch (node.op)
+        {
+            case DensityOp::Constant: result = node.value; break;
+            case DensityOp::X:        result = position[0]; break;
+            case DensityOp::Y:        result = position[1]; break;
+            case DensityOp::Z:        result = position[2]; break;
+            case DensityOp::Surface:  result = position[3]; break;
+            case DensityOp::FBm2D:
+            case DensityOp::FBm3D:
+                for (const NoiseOctave& octave : node.octaves) {
+                    float f = octave.frequency;
+                    float noise = node.op == DensityOp::FBm2D ? Density::Perlin2D(position[0] * f, position[2] * f)
+                                                              : Density::Noise3D(node.noise, position[0] * f, position[1] * f, position[2] * f);
+                    result += noise * octave.weight;
+                }
+                result *= node.value;
+                break;
+            case DensityOp::Mix:
+            {
+                float t = EvaluateNode(in[2], position, values, done);
+                float a = EvaluateNode(in[0], position, values, done);
+                result = t == 0.0f ? a : Apply(node.op, a, EvaluateNode(in[1], position, values, done), t);
+                break;
+            }
+            default:
+            {
+                float a = EvaluateNode(in[0], position, values, done);
+                float b = EvaluateNode(in[1], position, values, done);
+                float c = in[2] < 0 ? 0.0f : EvaluateNode(in[2], position, values, done);
+                result = Apply(node.op, a, b, c);
+            }
+        }
+        done[index] = 1;
+        values[index] = result;
+        return result;
+    }
+
+    void ScheduleNode(int index, std::vector<char>& visited, std::vector<int>& order) const
+    {
+        if (visited[index]) return;
+        visited[index] = 1;
+        const int* in = nodes[index].inputs;
+        const int inputOrder[3] = { 2, 0, 1 }; // BLEND WEIGHT FIRST
+        for (int i : inputOrder) {
+            if (in[i] >= 0) ScheduleNode(in[i], visited, order);
+        }
+        order.push_back(index);
+    }
+
+    // NODES REACHABLE FROM index WITHOUT GOING THROUGH THE b INPUT OF skipMix
+    void Mark(int index, int skipMix, std::vector<char>& visited) const
+    {
+        if (visited[index]) return;
+        visited[index] = 1;
+        for (int i=0; i<3; ++i) {
+            if (nodes[index].inputs[i] >= 0 && !(index == skipMix && i == 1)) Mark(nodes[index].inputs[i], skipMix, visited);
+        }
+    }
+
+    static bool GuardedBy(int index, int mix, const std::vector<int>& guards)
+    {
+        for (int guard = guards[index]; guard >= 0; guard = guards[guard]) {
+            if (guard == mix) return true;
+        }
+        return false;
+    }
+
+    static std::string Literal(float value)
+    {
+        // SHORTEST TEXT THAT READS BACK AS THE SAME FLOAT
+        char text[32];
+        for (int digits=6; digits<=9; ++digits) {
+            std::snprintf(text, sizeof(text), "%.*g", digits, value);
+            if (std::strtof(text, nullptr) == value) break;
+        }
+        std::string literal = text;
+        if (literal.find_first_of(".en") == std::string::npos) literal += ".0";
+        return literal;
+    }
+
+    static const char* GLSLNoiseFunction(NoiseBackend backend)
+    {
+        switch (backend)
+        {
+            case NoiseBackend::Permutation:  return "ImprovedPerlin3D";
+            case NoiseBackend::OpenSimplex2: return "OpenSimplex3D";
+            default:                         return "Perlin3D";
+        }
+    }
+
+    std::string Ref(int index) const
+    {
+        switch (nodes[index].op)
+        {
+            case DensityOp::Constant: return Literal(nodes[index].value);
+            case DensityOp::X:        return "x";
+            case DensityOp::Y:        return "y";
+            case DensityOp::Z:        return "z";
+            case DensityOp::Surface:  return "surfaceHeight";
+            default:                  return "n" + std::to_string(index);
+        }
+    }
+
+    // EMITS THE NODES index NEEDS BEFORE index ITSELF - THE b INPUT OF A BLEND GOES INSIDE if (t != 0.0)
+    void EmitNode(int index, const std::vector<int>& guards, std::vector<char>& emitted, std::string& body, const std::string& indent) const
+    {
+        const DensityNode& node = nodes[index];
+        if (emitted[index] || node.op == DensityOp::Constant || IsInput(node.op)) return;
+        emitted[index] = 1;
+        const int* in = node.inputs;
+        std::string name = Ref(index);
+
+        if (node.op == DensityOp::Mix)
+        {
+            EmitNode(in[2], guards, emitted, body, indent);
+            EmitNode(in[0], guards, emitted, body, indent);
+            EmitUnguarded(in[1], index, guards, emitted, body, indent);
+            body += indent + "float " + name + " = " + Ref(in[0]) + ";\n";
+            body += indent + "if (" + Ref(in[2]) + " != 0.0)\n" + indent + "{\n";
+            EmitNode(in[1], guards, emitted, body, indent + "    ");
+            body += indent + "    " + name + " = " + Ref(in[0]) + " + (" + Ref(in[1]) + " - " + Ref(in[0]) + ") * " + Ref(in[2]) + ";\n";
+            body += indent + "}\n";
+            return;
+        }
+
+        for (int i=0; i<3; ++i) {
+            if (in[i] >= 0) EmitNode(in[i], guards, emitted, body, indent);
+        }
+
+        std::string expression;
+        switch (node.op)
+        {
+            case DensityOp::FBm3D:
+                for (const NoiseOctave& octave : node.octaves) {
+                    std::string f = Literal(octave.frequency);
+                    if (!expression.empty()) expression += " + ";
+                    expression += std::string(GLSLNoiseFunction(node.noise)) + "(x * " + f + ", y * " + f + ", z * " + f + ")";
+                    if (octave.weight != 1.0f) expression += " * " + Literal(octave.weight);
+                }
+                if (node.value != 1.0f) expression = "(" + expression + ") * " + Literal(node.value);
+                break;
+            case DensityOp::FBm2D:
+                std::cout << "[Density Graph Error] 2D noise has no GLSL version - use it in the surface graph" << std::endl;
+                expression = "0.0";
+                break;
+            case DensityOp::Min:   expression = "min(" + Ref(in[0]) + ", " + Ref(in[1]) + ")"; break;
+            case DensityOp::Max:   expression = "max(" + Ref(in[0]) + ", " + Ref(in[1]) + ")"; break;
+            case DensityOp::Clamp: expression = "min(max(" + Ref(in[0]) + ", " + Ref(in[1]) + "), " + Ref(in[2]) + ")"; break;
+            default:
+            {
+                const char* symbol = node.op == DensityOp::Add ? " + " : node.op == DensityOp::Sub ? " - " : node.op == DensityOp::Mul ? " * " : " / ";
+                expression = Ref(in[0]) + symbol + Ref(in[1]);
+            }
+        }
+        body += indent + "float " + name + " = " + expression + ";\n";
+    }
+
+    // EMITS, OUTSIDE THE BLEND'S if, THE NODES ITS b INPUT SHARES WITH THE REST OF THE GRAPH
+    void EmitUnguarded(int index, int mix, const std::vector<int>& guards, std::vector<char>& emitted, std::string& body, const std::string& indent) const
+    {
+        if (!GuardedBy(index, mix, guards))
+        {
+            EmitNode(index, guards, emitted, body, indent);
+            return;
+        }
+        for (int input : nodes[index].inputs) {
+            if (input >= 0) EmitUnguarded(input, mix, guards, emitted, body, indent);
+        }
+    }
+};
+
+/*
+An optimized graph flattened into a list of steps, each run over a whole batch of points before the next.
+Noise steps go through the SIMD octaves, arithmetic steps are plain loops the compiler vectorizes, and steps only a
+blend's b input needs are skipped for every group of 8 points whose blend weight is 0.
+EvaluateInBox() is for batches inside a known box, like a mesher's slab: hashed 3D noise then looks its gradients up in
+a lattice built once per octave for the box instead of hashing 8 lattice points per point per octave.
+Evaluate() and EvaluateInBox() may be called from several threads at once.
+*/
+class DensityKernel
+{
+public:
+    static const int batchSize = 64;
+    static const int groupSize = 8;
+
+    explicit DensityKernel(const DensityGraph& source) : graph(source.Optimize())
+    {
+        const std::vector<DensityNode>& nodes = graph.Nodes();
+        std::vector<int> guards = graph.BlendGuards();
+        std::vector<int> stepOf(nodes.size(), -1);
+        for (int node : graph.Schedule())
+        {
+            stepOf[node] = static_cast<int>(steps.size());
+            Step step;
+            step.node = node;
+            step.guard = -1;
+            for (int i=0; i<3; ++i) step.inputs[i] = nodes[node].inputs[i] >= 0 ? stepOf[nodes[node].inputs[i]] : -1;
+            step.firstLattice = -1;
+            if (nodes[node].op == DensityOp::FBm3D && nodes[node].noise == NoiseBackend::Hash)
+            {
+                step.firstLattice = latticeCount;
+                latticeCount += static_cast<int>(nodes[node].octaves.size());
+            }
+            steps.push_back(step);
+        }
+        // A GUARD'S STEP ISN'T KNOWN UNTIL THE Mix IS SCHEDULED, AFTER THE NODES IT GUARDS
+        for (Step& step : steps) {
+            if (guards[step.node] >= 0) step.guard = stepOf[guards[step.node]];
+        }
+    }
+
+    const DensityGraph& Graph() const { return graph; }
+    int StepCount() const { return static_cast<int>(steps.size()); }
+
+    // ONE VALUE PER POINT - surfaceHeight IS THE COLUMN'S SURFACE HEIGHT FOR DENSITY GRAPHS, IGNORED BY SURFACE GRAPHS
+    void Evaluate(const float* x, const float* y, const float* z, const float* surfaceHeight, float* out, int count) const
+    {
+        Run(x, y, z, surfaceHeight, out, count, nullptr, nullptr);
+    }
+
+    // Evaluate FOR POINTS THAT ALL LIE IN THE WORLD SPACE BOX [lo, hi] - SAME RESULT, BIT FOR BIT
+    void EvaluateInBox(const float* x, const float* y, const float* z, const float* surfaceHeight, float* out, int count, const float lo[3], const float hi[3]) const
+    {
+        Run(x, y, z, surfaceHeight, out, count, lo, hi);
+    }
+
+private:
+    struct Step
+    {
+        int node;
+        int guard;        // STEP OF THE Mix WHOSE b INPUT IS THE ONLY USE OF THIS STEP, -1 IF NONE
+        int inputs[3];    // STEPS OF THE NODE'S INPUTS
+        int firstLattice; // HASHED FBm3D - INDEX OF ITS FIRST OCTAVE'S LATTICE, -1 FOR EVERY OTHER STEP
+    };
+
+    DensityGraph graph;
+    std::vector<Step> steps;
+    int latticeCount = 0;
+
+    // lo AND hi ARE NULL WHEN THE POINTS' BOX ISN'T KNOWN
+    void Run(const float* x, const float* y, const float* z, const float* surfaceHeight, float* out, int count, const float* lo, const float* hi) const
+    {
+        const std::vector<DensityNode>& nodes = graph.Nodes();
+        thread_local std::vector<DensitySIMD::GradientLattice> lattices;
+        thread_local std::vector<char> latticeState; // 0 NOT BUILT YET, 1 BUILT, 2 HASHING IS CHEAPER
+        lattices.resize(std::max<size_t>(lattices.size(), latticeCount));
+        latticeState.assign(latticeCount, lo ? 0 : 2);
+
+        thread_local std::vector<float> registers;
+        thread_local std::vector<const float*> operands;
+        thread_local std::vector<unsigned> gates;
+        thread_local std::vector<int> gateBatch;
+        registers.resize(steps.size() * batchSize);
+        operands.resize(steps.size());
+        gates.resize(steps.size());
+        gateBatch.assign(steps.size(), -1);
+
+        for (int start=0, batch=0; start<count; start += batchSize, ++batch)
+        {
+            int n = std::min(batchSize, count - start);
+            int groups = (n + groupSize - 1) / groupSize;
+            unsigned all = (1u << groups) - 1;
+            const float* position[4] = { x + start, y + start, z + start, surfaceHeight + start };
+
+            for (int s=0; s<StepCount(); ++s)
+            {
+                const Step& step = steps[s];
+                const DensityNode& node = nodes[step.node];
+                float* result = &registers[s * batchSize];
+                operands[s] = result;
+
+                switch (node.op)
+                {
+                    case DensityOp::X:       operands[s] = position[0]; continue;
+                    case DensityOp::Y:       operands[s] = position[1]; continue;
+                    case DensityOp::Z:       operands[s] = position[2]; continue;
+                    case DensityOp::Surface: operands[s] = position[3]; continue;
+                    case DensityOp::Constant:
+                        std::fill(result, result + n, node.value);
+                        continue;
+                    default: break;
+                }
+
+                // GROUPS THIS STEP HAS TO COMPUTE - THE REST ARE ZEROED SO THEY CAN'T CARRY NaNs INTO A BLEND
+                unsigned live = step.guard >= 0 ? Gate(step.guard, batch, all, n, operands, gates, gateBatch) : all;
+                if (live != all) std::fill(result, result + n, 0.0f);
+                if (live == 0) continue;
+
+                const float* a = step.inputs[0] >= 0 ? operands[step.inputs[0]] : nullptr;
+                const float* b = step.inputs[1] >= 0 ? operands[step.inputs[1]] : nullptr;
+                const float* c = step.inputs[2] >= 0 ? operands[step.inputs[2]] : nullptr;
+                auto each = [&](auto op) {
+                    for (int g=0; g<groups; ++g) {
+                        if (!(live >> g & 1)) continue;
+                        for (int i = g * groupSize; i < std::min(n, (g + 1) * groupSize); ++i) result[i] = op(i);
+                    }
+                };
+
+                switch (node.op)
+                {
+                    case DensityOp::FBm2D:
+                    case DensityOp::FBm3D:
+                    {
+                        alignas(32) float noise[groupSize];
+                        for (int g=0; g<groups; ++g)
+                        {
+                            if (!(live >> g & 1)) continue;
+                            int first = g * groupSize;
+                            int length = std::min(groupSize, n - first);
+                            std::fill(result + first, result + first + length, 0.0f);
+                            int o = 0;
+                            for (const NoiseOctave& octave : node.octaves)
+                            {
+                                if (node.op == DensityOp::FBm2D) DensitySIMD::Noise2D(position[0] + first, position[2] + first, octave.frequency, noise, length);
+                                // A SHORT GROUP HASHES - THE LATTICE HOLDS THE 8 WIDE GRADIENTS, THE SCALAR TAIL'S DIFFER IN THE LAST BIT
+                                else if (step.firstLattice >= 0 && length == groupSize && Lattice(step.firstLattice + o, octave.frequency, lo, hi, count, lattices, latticeState))
+                                {
+                                    DensitySIMD::Noise3D(lattices[step.firstLattice + o], position[0] + first, position[1] + first, position[2] + first, octave.frequency, noise, length);
+                                }
+                                else DensitySIMD::Noise3D(position[0] + first, position[1] + first, position[2] + first, octave.frequency, noise, length, node.noise);
+                                for (int i=0; i<length; ++i) result[first + i] += noise[i] * octave.weight;
+                                o += 1;
+                            }
+                            for (int i=0; i<length; ++i) result[first + i] *= node.value;
+                        }
+                        break;
+                    }
+                    case DensityOp::Add:   each([&](int i) { return a[i] + b[i]; }); break;
+                    case DensityOp::Sub:   each([&](int i) { return a[i] - b[i]; }); break;
+                    case DensityOp::Mul:   each([&](int i) { return a[i] * b[i]; }); break;
+                    case DensityOp::Div:   each([&](int i) { return a[i] / b[i]; }); break;
+                    case DensityOp::Min:   each([&](int i) { return std::min(a[i], b[i]); }); break;
+                    case DensityOp::Max:   each([&](int i) { return std::max(a[i], b[i]); }); break;
+                    case DensityOp::Clamp: each([&](int i) { return std::min(std::max(a[i], b[i]), c[i]); }); break;
+                    case DensityOp::Mix:   each([&](int i) { return a[i] + (b[i] - a[i]) * c[i]; }); break;
+                    default: break;
+                }
+            }
+            std::copy(operands[steps.size() - 1], operands[steps.size() - 1] + n, out + start);
+        }
+    }
+
+    // TRUE WHEN LATTICE i HOLDS THE BOX AT THIS FREQUENCY - BUILT ON FIRST USE, SO A BLEND THAT SKIPS THE NOISE SKIPS IT TOO
+    // A LATTICE WITH MORE POINTS THAN THE BATCH (HIGH OCTAVES OVER A SPARSE LOD BATCH) WOULD HASH MORE THAN IT SAVES
+    static bool Lattice(int i, float frequency, const float* lo, const float* hi, int count, std::vector<DensitySIMD::GradientLattice>& lattices, std::vector<char>& state)
+    {
+        if (state[i] == 0)
+        {
+            // THE SAME MULTIPLICATION AS THE NOISE CALL, SO THE SCALED BOX HOLDS EVERY SCALED POINT
+            float scaledLo[3], scaledHi[3];
+            long points = 1;
+            for (int axis=0; axis<3; ++axis) {
+                scaledLo[axis] = lo[axis] * frequency;
+                scaledHi[axis] = hi[axis] * frequency;
+                points *= static_cast<long>(std::floor(scaledHi[axis])) - static_cast<long>(std::floor(scaledLo[axis])) + 2;
+            }
+            state[i] = 2;
+            if (points <= count)
+            {
+                lattices[i].Build(scaledLo, scaledHi);
+                if (!lattices[i].global) state[i] = 1;
+            }
+        }
+        return state[i] == 1;
+    }
+
+    // GROUPS OF THE BATCH WHERE THE BLEND AT mixStep, AND EVERY BLEND AROUND IT, HAS A NON-ZERO WEIGHT
+    unsigned Gate(int mixStep, int batch, unsigned all, int n, const std::vector<const float*>& operands, std::vector<unsigned>& gates, std::vector<int>& gateBatch) const
+    {
+        if (gateBatch[mixStep] == batch) return gates[mixStep];
+        const Step& mix = steps[mixStep];
+        unsigned gate = mix.guard >= 0 ? Gate(mix.guard, batch, all, n, operands, gates, gateBatch) : all;
+        const float* t = operands[mix.inputs[2]];
+        unsigned blended = 0;
+        for (int i=0; i<n; ++i) {
+            if (t[i] != 0.0f) blended |= 1u << (i / groupSize);
+        }
+        gates[mixStep] = gate & blended;
+        gateBatch[mixStep] = batch;
+        return gates[mixStep];
+    }
+};
+
+// A WORLD'S TERRAIN - SURFACE HEIGHT OVER (x, z) AND DENSITY OVER (x, y, z) GIVEN THAT HEIGHT
+struct TerrainShape
+{
+    DensityGraph surface;
+    DensityGraph density;
+    bool bounded = false; // TRUE FOR THE SHAPE Density::ChunkBounds BOUNDS - OTHER SHAPES ARE MESHED WITHOUT CLASSIFYING
+};
+
+// THE TERRAIN OF Density::GetSurfaceHeight AND Density::GetDensity, WITH ITS CAVES FROM ANY 3D NOISE BACKEND
+inline TerrainShape DefaultTerrainShape(NoiseBackend caveNoise = NoiseBackend::Hash)
+{
+    TerrainShape shape;
+    shape.bounded = caveNoise == NoiseBackend::Hash;
+
+    DensityGraph& surface = shape.surface;
+    surface.root = surface.FBm2D({ { 0.005f, 40.0f }, { 0.01f, 20.0f }, { 0.02f, 10.0f }, { 0.04f, 5.0f }, { 0.08f, 2.5f } });
+
+    DensityGraph& density = shape.density;
+    int surfaceHeight = density.Scale(density.Surface(), Density::surfaceScale);
+    int surfaceDensity = density.Clamp(density.HeightGradient(surfaceHeight, 1.0f), 0.0f, 1.0f);
+    int cave = density.Scale(density.FBm3D({ { 0.05f, 1.0f }, { 0.1f, 0.5f }, { 0.2f, 0.25f }, { 0.4f, 0.15f } }, caveNoise), Density::caveScale);
+    int blendTerm = density.Clamp(density.HeightGradient(density.Offset(surfaceHeight, Density::blendDistance), Density::blendDistance), 0.0f, 1.0f);
+    density.root = density.Mix(surfaceDensity, cave, blendTerm);
+    return shape;
+}
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef DENSITY_MULTIRES_H
+#define DENSITY_MULTIRES_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include "density.h"
+#include "density_simd.h"
+#include "edit_overlay.h"
+#include "chunk_config.h"
+
+/*
+Multi-resolution chunk density: FillChunk with the low frequency octaves sampled on a coarser grid.
+Each octave is evaluated at every stride-th corner (the stride divides the chunk size, so the coarse grid lands on
+corners) and upsampled bilinearly (surface) or trilinearly (caves); the rest run at full resolution.
+Linear interpolation over cells of size h is off by at most h^2 / 8 times the sum of the second derivatives along
+the axes, so the error of every octave at every stride is known up front. ChooseStrides spends an error budget on
+the strides that save the most samples per unit of error. With every stride at 1 the result is FillChunk's, bit for bit.
+*/
+
+namespace DensitySIMD
+{
+    // MUST MATCH GetSurfaceHeight AND GetCaveDensity
+    const float surfaceFrequencies[5] = { 0.005f, 0.01f, 0.02f, 0.04f, 0.08f };
+    const float surfaceAmplitudes[5]  = { 40.0f, 20.0f, 10.0f, 5.0f, 2.5f };
+    const float caveWeights[4]        = { 1.0f, 0.5f, 0.25f, 0.15f };
+
+    // LARGEST SUM OF |d2 / du2| OVER THE AXES FOR ONE NOISE OCTAVE AT FREQUENCY 1 - THE MAXIMUM OVER 4e6 RANDOM POINTS
+    // (14.4 FOR Perlin2D, 9.9 FOR Perlin3D) PLUS 25%
+    const float perlin2DCurvature = 18.0f;
+    const float perlin3DCurvature = 12.5f;
+
+    // HOW FAR THE DENSITY CAN MOVE PER UNIT OF (UNSCALED) SURFACE HEIGHT
+    // density = sd + (cave - sd) * t WITH sd AND t MOVING BY surfaceScale AND surfaceScale / blendDistance PER UNIT
+    const float surfaceSensitivity = Density::surfaceScale * (1.0f + std::max(Density::caveMax, 1.0f) / Density::blendDistance);
+
+    struct OctaveStrides
+    {
+        int surface[5] = { 1, 1, 1, 1, 1 };
+        int cave[4] = { 1, 1, 1, 1 };
+        float error = 0.0f; // BOUND ON |density - FillChunk's density|
+    };
+
+    inline float SurfaceOctaveError(int octave, int stride)
+    {
+        float h = surfaceFrequencies[octave] * stride;
+        return surfaceAmplitudes[octave] * surfaceSensitivity * h * h / 8.0f * perlin2DCurvature;
+    }
+
+    inline float CaveOctaveError(int octave, int stride)
+    {
+        float h = 0.05f * (1 << octave) * stride;
+        return caveWeights[octave] * Density::caveScale * h * h / 8.0f * perlin3DCurvature;
+    }
+
+    // THE STRIDES WITH THE FEWEST NOISE SAMPLES PER CHUNK WHOSE ERROR BOUNDS ADD UP TO AT MOST maxError
+    // GREEDY: EACH STEP RAISES THE ONE OCTAVE WHOSE NEXT STRIDE SAVES THE MOST SAMPLES PER UNIT OF ADDED ERROR
+    inline OctaveStrides ChooseStrides(float maxError)
+    {
+        using namespace ChunkConfig;
+
+        std::vector<int> divisors;
+        for (int stride=1; stride<=std::min(width, height); ++stride) {
+            if (width % stride == 0 && height % stride == 0) divisors.push_back(stride);
+        }
+        auto Next = [&](int stride) {
+            auto next = std::upper_bound(divisors.begin(), divisors.end(), stride);
+            return next == divisors.end() ? 0 : *next;
+        };
+        auto Samples2D = [](int stride) { return (width / stride + 1) * (width / stride + 1); };
+        auto Samples3D = [](int stride) { return (width / stride + 1) * (height / stride + 1) * (width / stride + 1); };
+
+        OctaveStrides strides;
+        for (;;)
+        {
+            int* best = nullptr;
+            int bestStride = 0;
+            float bestError = 0.0f, bestRatio = 0.0f;
+            for (int octave=0; octave<9; ++octave)
+            {
+                bool cave = octave >= 5;
+                int* stride = cave ? &strides.cave[octave - 5] : &strides.surface[octave];
+                int next = Next(*stride);
+                if (next == 0) continue;
+
+                float added = cave ? CaveOctaveError(octave - 5, next) - CaveOctaveError(octave - 5, *stride)
+                                   : SurfaceOctaveError(octave, next) - SurfaceOctaveError(octave, *stride);
+                int saved = cave ? Samples3D(*stride) - Samples3D(next) : Samples2D(*stride) - Samples2D(next);
+                if (strides.error + added > maxError) continue;
+
+                float ratio = saved / std::max(added, 1e-12f);
+                if (ratio > bestRatio) {
+                    best = stride;
+                    bestStride = next;
+                    bestError = added;
+                    bestRatio = ratio;
+                }
+            }
+            if (!best) return strides;
+            *best = bestStride;
+            strides.error += bestError;
+        }
+    }
+
+    // INDEX OF THE COARSE SAMPLE BELOW EACH CORNER ALONG ONE AXIS, AND THE WEIGHT OF THE ONE ABOVE IT
+    inline void UpsampleWeights(int corners, int stride, int* index, float* weight)
+    {
+        int samples = (corners - 1) / stride + 1;
+        for (int i=0; i<corners; ++i) {
+            index[i] = std::min(i / stride, std::max(samples - 2, 0));
+            weight[i] = static_cast<float>(i - index[i] * stride) / static_cast<float>(stride);
+        }
+    }
+
+    // TRILINEAR UPSAMPLING OF ((width / stride + 1) x (height / stride + 1) x (width / stride + 1)) SAMPLES TO EVERY CORNER
+    // ONE AXIS AT A TIME - X, THEN Y, THEN Z, THE SAME LERPS AS INTERPOLATING EACH CORNER ON ITS OWN
+    inline void Upsample3D(const float* samples, int stride, float* out)
+    {
+        using namespace ChunkConfig;
+        const int acrossX = width / stride + 1, acrossY = height / stride + 1;
+        int index[std::max(cornersX, cornersY)];
+        float weight[std::max(cornersX, cornersY)];
+        thread_local std::vector<float> rows, slices;
+        rows.resize(cornersX * acrossY * acrossX);
+        slices.resize(cornersX * cornersY * acrossX);
+
+        UpsampleWeights(cornersX, stride, index, weight);
+        for (int row=0; row<acrossY * acrossX; ++row) {
+            const float* s = samples + row * acrossX;
+            for (int x=0; x<cornersX; ++x) rows[x + row * cornersX] = s[index[x]] + (s[index[x] + 1] - s[index[x]]) * weight[x];
+        }
+
+        UpsampleWeights(cornersY, stride, index, weight);
+        for (int z=0; z<acrossX; ++z) {
+            for (int y=0; y<cornersY; ++y) {
+                const float* near = &rows[(index[y] + z * acrossY) * cornersX];
+                const float* far = near + cornersX;
+                float* slice = &slices[(y + z * cornersY) * cornersX];
+                for (int x=0; x<cornersX; ++x) slice[x] = near[x] + (far[x] - near[x]) * weight[y];
+            }
+        }
+
+        UpsampleWeights(cornersX, stride, index, weight);
+        const int sliceSize = cornersX * cornersY;
+        for (int z=0; z<cornersX; ++z) {
+            const float* near = &slices[index[z] * sliceSize];
+            const float* far = near + sliceSize;
+            for (int i=0; i<sliceSize; ++i) out[i + z * sliceSize] = near[i] + (far[i] - near[i]) * weight[z];
+        }
+        std::fill(out + cornerCount, out + (cornerCount + 7) / 8 * 8, out[cornerCount - 1]);
+    }
+
+    // ONE CAVE OCTAVE AT count WORLD SPACE POINTS - THE SAME FLOAT OPERATIONS AS GetCaveDensity
+    inline void CaveOctave(const GradientLattice& lattice, int octave, const float* x, const float* y, const float* z, float* out, int count)
+    {
+        float scale = static_cast<float>(1 << octave);
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 frequency = _mm256_set1_ps(0.05f), octaveScale = _mm256_set1_ps(scale);
+        for (; i + 8 <= count; i += 8) {
+            __m256 sx = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(x + i), frequency), octaveScale);
+            __m256 sy = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(y + i), frequency), octaveScale);
+            __m256 sz = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(z + i), frequency), octaveScale);
+            _mm256_storeu_ps(out + i, Perlin3D(lattice, sx, sy, sz));
+        }
+#endif
+        for (; i<count; ++i) out[i] = Perlin3D(lattice, x[i] * 0.05f * scale, y[i] * 0.05f * scale, z[i] * 0.05f * scale);
+    }
+
+    // FillChunk WITH EACH OCTAVE SAMPLED EVERY strides CORNERS - WITHIN strides.error OF IT
+    inline void FillChunkMultiResolution(int chunkX, int chunkY, int chunkZ, const EditBrick* edits, float* out, const OctaveStrides& strides)
+    {
+        using namespace ChunkConfig;
+
+        const int paddedCount = (cornerCount + 7) / 8 * 8;
+        const int columns = cornersX * cornersX;
+        thread_local std::vector<float> xs, ys, zs, surface, columnHeight, values, sampleX, sampleY, sampleZ, samples;
+        xs.resize(paddedCount);
+        ys.resize(paddedCount);
+        zs.resize(paddedCount);
+        surface.resize(paddedCount);
+        values.resize(paddedCount);
+        columnHeight.assign(columns, 0.0f);
+
+        int indexX[cornersX];
+        float weightX[cornersX];
+
+        // SURFACE OCTAVES ON (cornersX / stride)^2 COLUMNS, ADDED UP IN GetSurfaceHeight'S ORDER
+        for (int octave=0; octave<5; ++octave)
+        {
+            int stride = strides.surface[octave];
+            int across = width / stride + 1;
+            int count = (across * across + 7) / 8 * 8;
+            sampleX.resize(count);
+            sampleZ.resize(count);
+            samples.resize(count);
+            for (int i=0; i<count; ++i) {
+                int sample = std::min(i, across * across - 1);
+                sampleX[i] = static_cast<float>(chunkX + sample % across * stride);
+                sampleZ[i] = static_cast<float>(chunkZ + sample / across * stride);
+            }
+            Noise2D(sampleX.data(), sampleZ.data(), surfaceFrequencies[octave], samples.data(), count);
+
+            UpsampleWeights(cornersX, stride, indexX, weightX);
+            for (int z=0; z<cornersX; ++z) {
+                for (int x=0; x<cornersX; ++x) {
+                    float value;
+                    if (stride == 1) value = samples[x + z * across];
+                    else
+                    {
+                        const float* s = &samples[indexX[x] + indexX[z] * across];
+                        float near = s[0] + (s[1] - s[0]) * weightX[x];
+                        float far = s[across] + (s[across + 1] - s[across]) * weightX[x];
+                        value = near + (far - near) * weightX[z];
+                    }
+                    columnHeight[x + z * cornersX] += value * surfaceAmplitudes[octave];
+                }
+            }
+        }
+
+        for (int i=0; i<paddedCount; ++i) {
+            int corner = std::min(i, cornerCount - 1);
+            int x = corner % cornersX;
+            int y = corner / cornersX % cornersY;
+            int z = corner / (cornersX * cornersY);
+            xs[i] = static_cast<float>(chunkX + x);
+            ys[i] = static_cast<float>(chunkY + y);
+            zs[i] = static_cast<float>(chunkZ + z);
+            surface[i] = columnHeight[x + z * cornersX];
+        }
+
+        // COARSE CAVE OCTAVES, UPSAMPLED TO EVERY CORNER - ONLY IF SOME CORNER REACHES DOWN INTO THE BLEND BAND, LIKE FillChunk
+        thread_local CaveLattices caves;
+        thread_local std::vector<float> upsampled[4];
+        float blendTop = -1e30f;
+        for (int i=0; i<columns; ++i) blendTop = std::max(blendTop, columnHeight[i] * Density::surfaceScale + Density::blendDistance);
+        if (static_cast<float>(chunkY) < blendTop)
+        {
+            caves.Build(chunkX, chunkY, chunkZ);
+            for (int octave=0; octave<4; ++octave)
+            {
+                int stride = strides.cave[octave];
+                if (stride == 1) continue;
+
+                int acrossX = width / stride + 1, acrossY = height / stride + 1;
+                int count = (acrossX * acrossY * acrossX + 7) / 8 * 8;
+                sampleX.resize(count);
+                sampleY.resize(count);
+                sampleZ.resize(count);
+                samples.resize(count);
+                for (int i=0; i<count; ++i) {
+                    int sample = std::min(i, acrossX * acrossY * acrossX - 1);
+                    sampleX[i] = static_cast<float>(chunkX + sample % acrossX * stride);
+                    sampleY[i] = static_cast<float>(chunkY + sample / acrossX % acrossY * stride);
+                    sampleZ[i] = static_cast<float>(chunkZ + sample / (acrossX * acrossY) * stride);
+                }
+                CaveOctave(caves.octaves[octave], octave, sampleX.data(), sampleY.data(), sampleZ.data(), samples.data(), count);
+                upsampled[octave].resize(paddedCount);
+                Upsample3D(samples.data(), stride, upsampled[octave].data());
+            }
+        }
+
+        // GetDensity WITH THE FULL RESOLUTION OCTAVES EVALUATED ONLY WHERE IT ASKS FOR THE CAVE TERM
+        const GradientLattice* lattices = caves.octaves;
+        const float* coarse[4];
+        for (int octave=0; octave<4; ++octave) coarse[octave] = strides.cave[octave] == 1 ? nullptr : upsampled[octave].data();
+        int i = 0;
+#if defined(__AVX2__)
+        auto caveTerm = [&](__m256 x, __m256 y, __m256 z) {
+            __m256 sx = _mm256_mul_ps(x, _mm256_set1_ps(0.05f));
+            __m256 sy = _mm256_mul_ps(y, _mm256_set1_ps(0.05f));
+            __m256 sz = _mm256_mul_ps(z, _mm256_set1_ps(0.05f));
+            __m256 density = _mm256_setzero_ps();
+            for (int octave=0; octave<4; ++octave)
+            {
+                __m256 noise;
+                if (coarse[octave]) noise = _mm256_loadu_ps(coarse[octave] + i);
+                else
+                {
+                    __m256 scale = _mm256_set1_ps(static_cast<float>(1 << octave));
+                    noise = Perlin3D(lattices[octave], _mm256_mul_ps(sx, scale), _mm256_mul_ps(sy, scale), _mm256_mul_ps(sz, scale));
+                }
+                density = _mm256_add_ps(density, _mm256_mul_ps(noise, _mm256_set1_ps(caveWeights[octave])));
+            }
+            return density;
+        };
+        for (; i + 8 <= paddedCount; i += 8) {
+            __m256 density = GetDensity(_mm256_loadu_ps(&xs[i]), _mm256_loadu_ps(&ys[i]), _mm256_loadu_ps(&zs[i]), _mm256_loadu_ps(&surface[i]), caveTerm);
+            _mm256_storeu_ps(&values[i], density);
+        }
+#endif
+        auto caveTerm1 = [&](float x, float y, float z) {
+            float sx = x * 0.05f, sy = y * 0.05f, sz = z * 0.05f;
+            float density = 0.0f;
+            for (int octave=0; octave<4; ++octave) {
+                float scale = static_cast<float>(1 << octave);
+                float noise = coarse[octave] ? coarse[octave][i] : Perlin3D(lattices[octave], sx * scale, sy * scale, sz * scale);
+                density += noise * caveWeights[octave];
+            }
+            return density;
+        };
+        for (; i<paddedCount; ++i) values[i] = Density::GetDensity(xs[i], ys[i], zs[i], surface[i], caveTerm1);
+
+        std::copy(values.begin(), values.begin() + cornerCount, out);
+        AddEdits(edits, out);
+    }
+}
+
+#endif
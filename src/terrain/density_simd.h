@@ -0,0 +1,741 @@
+#ifndef DENSITY_SIMD_H
+#define DENSITY_SIMD_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "density.h"
+#include "noise_backends.h"
+#include "edit_overlay.h"
+#include "chunk_config.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+Batched CPU evaluation of the terrain density, for hosts without a GPU.
+With AVX2 (build with -mavx2) every noise function runs on 8 points per instruction, otherwise each point goes
+through the scalar functions in density.h. The AVX2 path replaces std::sin / std::cos with polynomials accurate
+to about 1e-7 over the gradient angle range [0, Pi], so both paths agree with each other to within about 1e-5
+and with the shader to within maxShaderError.
+*/
+
+namespace DensitySIMD
+{
+    // TOLERANCE AGAINST THE COMPUTE SHADER - MESA'S SOFTWARE RASTERIZER AGREES TO 6e-7, HARDWARE SIN / COS ARE COARSER
+    const float maxShaderError = 1e-4f;
+
+#if defined(__AVX2__)
+    const int lanes = 8;
+
+    inline __m256i Rotate16(__m256i v)
+    {
+        return _mm256_or_si256(_mm256_slli_epi32(v, 16), _mm256_srli_epi32(v, 16));
+    }
+
+    // AVX2 ONLY CONVERTS SIGNED INTS - BOTH HALVES CONVERT EXACTLY, SO THE SUM ROUNDS ONCE LIKE float(uint)
+    inline __m256 UintToFloat(__m256i v)
+    {
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(v, 16));
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(v, _mm256_set1_epi32(0xFFFF)));
+        return _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+    }
+
+    // SIN AND COS OF ANGLES IN [0, Pi] - TAYLOR SERIES AROUND Pi / 2, WHERE sin(r) = cos(t) AND cos(r) = -sin(t)
+    inline void SinCos(__m256 r, __m256& sinR, __m256& cosR)
+    {
+        __m256 t = _mm256_sub_ps(r, _mm256_set1_ps(1.57079633f));
+        __m256 t2 = _mm256_mul_ps(t, t);
+
+        __m256 sinT = _mm256_set1_ps(-2.50521084e-8f);
+        sinT = _mm256_add_ps(_mm256_mul_ps(sinT, t2), _mm256_set1_ps(2.75573192e-6f));
+        sinT = _mm256_add_ps(_mm256_mul_ps(sinT, t2), _mm256_set1_ps(-1.98412698e-4f));
+        sinT = _mm256_add_ps(_mm256_mul_ps(sinT, t2), _mm256_set1_ps(8.33333333e-3f));
+        sinT = _mm256_add_ps(_mm256_mul_ps(sinT, t2), _mm256_set1_ps(-1.66666667e-1f));
+        sinT = _mm256_add_ps(_mm256_mul_ps(sinT, t2), _mm256_set1_ps(1.0f));
+        sinT = _mm256_mul_ps(sinT, t);
+
+        __m256 cosT = _mm256_set1_ps(2.08767570e-9f);
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(-2.75573192e-7f));
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(2.48015873e-5f));
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(-1.38888889e-3f));
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(4.16666667e-2f));
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(-0.5f));
+        cosT = _mm256_add_ps(_mm256_mul_ps(cosT, t2), _mm256_set1_ps(1.0f));
+
+        sinR = cosT;
+        cosR = _mm256_sub_ps(_mm256_setzero_ps(), sinT);
+    }
+
+    // SAME HASH AS Density::RandomGradient2D, TURNED INTO AN ANGLE IN [0, Pi]
+    inline __m256 RandomAngle2D(__m256i ix, __m256i iy, __m256i& a, __m256i& b)
+    {
+        a = _mm256_mullo_epi32(ix, _mm256_set1_epi32(static_cast<int>(3284157443U)));
+        b = _mm256_xor_si256(iy, Rotate16(a));
+        b = _mm256_mullo_epi32(b, _mm256_set1_epi32(static_cast<int>(1911520717U)));
+        a = _mm256_xor_si256(a, Rotate16(b));
+        a = _mm256_mullo_epi32(a, _mm256_set1_epi32(static_cast<int>(2048419325U)));
+        return _mm256_mul_ps(UintToFloat(a), _mm256_set1_ps(3.14159265f / 4294967296.0f));
+    }
+
+    inline __m256 DotGridGradient2D(__m256i ix, __m256i iy, __m256 dx, __m256 dy)
+    {
+        __m256i a, b;
+        __m256 gx, gy;
+        SinCos(RandomAngle2D(ix, iy, a, b), gx, gy);
+        return _mm256_add_ps(_mm256_mul_ps(gx, dx), _mm256_mul_ps(gy, dy));
+    }
+
+    inline void RandomGradient3D(__m256i ix, __m256i iy, __m256i iz, __m256& gx, __m256& gy, __m256& gz)
+    {
+        __m256i a, b;
+        __m256 randomX = RandomAngle2D(ix, iy, a, b);
+
+        __m256i c = _mm256_mullo_epi32(iz, _mm256_set1_epi32(static_cast<int>(3329032859U)));
+        c = _mm256_xor_si256(c, Rotate16(a));
+        c = _mm256_mullo_epi32(c, _mm256_set1_epi32(static_cast<int>(1431691223U)));
+        b = _mm256_xor_si256(b, Rotate16(c));
+        b = _mm256_mullo_epi32(b, _mm256_set1_epi32(static_cast<int>(1812433253U)));
+        __m256 randomZ = _mm256_mul_ps(UintToFloat(b), _mm256_set1_ps(3.14159265f / 4294967296.0f));
+
+        __m256 sinX, cosX, cosZ;
+        SinCos(randomX, sinX, cosX);
+        SinCos(randomZ, gz, cosZ);
+        gx = _mm256_mul_ps(sinX, cosZ);
+        gy = _mm256_mul_ps(cosX, cosZ);
+    }
+
+    inline __m256 DotGridGradient3D(__m256i ix, __m256i iy, __m256i iz, __m256 dx, __m256 dy, __m256 dz)
+    {
+        __m256 gx, gy, gz;
+        RandomGradient3D(ix, iy, iz, gx, gy, gz);
+        __m256 dot = _mm256_mul_ps(gx, dx);
+        dot = _mm256_add_ps(dot, _mm256_mul_ps(gy, dy));
+        return _mm256_add_ps(dot, _mm256_mul_ps(gz, dz));
+    }
+
+    inline __m256 Interpolate(__m256 a0, __m256 a1, __m256 w)
+    {
+        __m256 weight = _mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(w, _mm256_set1_ps(2.0f)));
+        return _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_sub_ps(a1, a0), weight), w), w), a0);
+    }
+
+    inline __m256 Perlin2D(__m256 x, __m256 y)
+    {
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256i x0 = _mm256_cvttps_epi32(fx);
+        __m256i y0 = _mm256_cvttps_epi32(fy);
+        __m256i x1 = _mm256_add_epi32(x0, _mm256_set1_epi32(1));
+        __m256i y1 = _mm256_add_epi32(y0, _mm256_set1_epi32(1));
+
+        // OFFSETS FROM THE LOW AND HIGH CORNERS - ALSO THE INTERPOLATION WEIGHTS
+        __m256 sx = _mm256_sub_ps(x, fx);
+        __m256 sy = _mm256_sub_ps(y, fy);
+        __m256 sx1 = _mm256_sub_ps(sx, _mm256_set1_ps(1.0f));
+        __m256 sy1 = _mm256_sub_ps(sy, _mm256_set1_ps(1.0f));
+
+        __m256 n0 = DotGridGradient2D(x0, y0, sx,  sy);
+        __m256 n1 = DotGridGradient2D(x1, y0, sx1, sy);
+        __m256 n2 = DotGridGradient2D(x0, y1, sx,  sy1);
+        __m256 n3 = DotGridGradient2D(x1, y1, sx1, sy1);
+
+        return Interpolate(Interpolate(n0, n1, sx), Interpolate(n2, n3, sx), sy);
+    }
+
+    inline __m256 Perlin3D(__m256 x, __m256 y, __m256 z)
+    {
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256 fz = _mm256_floor_ps(z);
+        __m256i one = _mm256_set1_epi32(1);
+        __m256i x0 = _mm256_cvttps_epi32(fx);
+        __m256i y0 = _mm256_cvttps_epi32(fy);
+        __m256i z0 = _mm256_cvttps_epi32(fz);
+        __m256i x1 = _mm256_add_epi32(x0, one);
+        __m256i y1 = _mm256_add_epi32(y0, one);
+        __m256i z1 = _mm256_add_epi32(z0, one);
+
+        __m256 sx = _mm256_sub_ps(x, fx);
+        __m256 sy = _mm256_sub_ps(y, fy);
+        __m256 sz = _mm256_sub_ps(z, fz);
+        __m256 sx1 = _mm256_sub_ps(sx, _mm256_set1_ps(1.0f));
+        __m256 sy1 = _mm256_sub_ps(sy, _mm256_set1_ps(1.0f));
+        __m256 sz1 = _mm256_sub_ps(sz, _mm256_set1_ps(1.0f));
+
+        // Bottom corners
+        __m256 n0 = DotGridGradient3D(x0, y0, z0, sx,  sy,  sz);
+        __m256 n1 = DotGridGradient3D(x1, y0, z0, sx1, sy,  sz);
+        __m256 n2 = DotGridGradient3D(x0, y1, z0, sx,  sy1, sz);
+        __m256 n3 = DotGridGradient3D(x1, y1, z0, sx1, sy1, sz);
+
+        // Top corners
+        __m256 n4 = DotGridGradient3D(x0, y0, z1, sx,  sy,  sz1);
+        __m256 n5 = DotGridGradient3D(x1, y0, z1, sx1, sy,  sz1);
+        __m256 n6 = DotGridGradient3D(x0, y1, z1, sx,  sy1, sz1);
+        __m256 n7 = DotGridGradient3D(x1, y1, z1, sx1, sy1, sz1);
+
+        __m256 iy0 = Interpolate(Interpolate(n0, n1, sx), Interpolate(n2, n3, sx), sy);
+        __m256 iy1 = Interpolate(Interpolate(n4, n5, sx), Interpolate(n6, n7, sx), sy);
+        __m256 value = Interpolate(iy0, iy1, sz);
+        return _mm256_mul_ps(_mm256_add_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+    }
+
+    inline __m256 GetSurfaceHeight(__m256 x, __m256 z)
+    {
+        const float frequencies[5] = { 0.005f, 0.01f, 0.02f, 0.04f, 0.08f };
+        const float amplitudes[5]  = { 40.0f, 20.0f, 10.0f, 5.0f, 2.5f };
+        __m256 height = _mm256_setzero_ps();
+        for (int octave=0; octave<5; ++octave)
+        {
+            __m256 frequency = _mm256_set1_ps(frequencies[octave]);
+            __m256 noise = Perlin2D(_mm256_mul_ps(x, frequency), _mm256_mul_ps(z, frequency));
+            height = _mm256_add_ps(height, _mm256_mul_ps(noise, _mm256_set1_ps(amplitudes[octave])));
+        }
+        return height;
+    }
+
+    inline __m256 GetCaveDensity(__m256 x, __m256 y, __m256 z)
+    {
+        const float weights[4] = { 1.0f, 0.5f, 0.25f, 0.15f };
+        __m256 sx = _mm256_mul_ps(x, _mm256_set1_ps(0.05f));
+        __m256 sy = _mm256_mul_ps(y, _mm256_set1_ps(0.05f));
+        __m256 sz = _mm256_mul_ps(z, _mm256_set1_ps(0.05f));
+        __m256 density = _mm256_setzero_ps();
+        for (int octave=0; octave<4; ++octave)
+        {
+            __m256 scale = _mm256_set1_ps(static_cast<float>(1 << octave));
+            __m256 noise = Perlin3D(_mm256_mul_ps(sx, scale), _mm256_mul_ps(sy, scale), _mm256_mul_ps(sz, scale));
+            density = _mm256_add_ps(density, _mm256_mul_ps(noise, _mm256_set1_ps(weights[octave])));
+        }
+        return density;
+    }
+
+    // cave(x, y, z) RETURNS GetCaveDensity - ONLY CALLED WHEN SOME LANE IS INSIDE THE BLEND BAND
+    template <typename CaveFunction>
+    inline __m256 GetDensity(__m256 x, __m256 y, __m256 z, __m256 surfaceHeight, CaveFunction cave)
+    {
+        __m256 scaledSurface = _mm256_mul_ps(surfaceHeight, _mm256_set1_ps(Density::surfaceScale));
+        __m256 surfaceDensity = _mm256_sub_ps(scaledSurface, y);
+        surfaceDensity = _mm256_min_ps(_mm256_max_ps(surfaceDensity, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+
+        // SKIP THE CAVE OCTAVES WHEN EVERY LANE IS ABOVE THE BLEND BAND
+        __m256 blendTop = _mm256_add_ps(scaledSurface, _mm256_set1_ps(Density::blendDistance));
+        if (_mm256_movemask_ps(_mm256_cmp_ps(y, blendTop, _CMP_LT_OQ)) == 0) return surfaceDensity;
+
+        __m256 caveDensity = _mm256_mul_ps(cave(x, y, z), _mm256_set1_ps(Density::caveScale));
+        __m256 blendTerm = _mm256_div_ps(_mm256_sub_ps(blendTop, y), _mm256_set1_ps(Density::blendDistance));
+        blendTerm = _mm256_min_ps(_mm256_max_ps(blendTerm, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+        return _mm256_add_ps(surfaceDensity, _mm256_mul_ps(_mm256_sub_ps(caveDensity, surfaceDensity), blendTerm));
+    }
+
+    inline __m256 GetDensity(__m256 x, __m256 y, __m256 z, __m256 surfaceHeight)
+    {
+        return GetDensity(x, y, z, surfaceHeight, [](__m256 x, __m256 y, __m256 z) { return GetCaveDensity(x, y, z); });
+    }
+
+    // Density::EdgeGradientDot WITH THE REFERENCE grad() BIT TRICKS INSTEAD OF A TABLE LOOKUP
+    inline __m256 EdgeGradientDot(__m256i hash, __m256 x, __m256 y, __m256 z)
+    {
+        __m256i h = _mm256_and_si256(hash, _mm256_set1_epi32(15));
+        __m256 below8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+        __m256 below4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+        __m256 twelveOrFourteen = _mm256_castsi256_ps(_mm256_or_si256(_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)), _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+        __m256 u = _mm256_blendv_ps(y, x, below8);
+        __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, twelveOrFourteen), y, below4);
+        u = _mm256_xor_ps(u, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31)));
+        v = _mm256_xor_ps(v, _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30)));
+        return _mm256_add_ps(u, v);
+    }
+
+    inline __m256 Fade(__m256 t)
+    {
+        __m256 inner = _mm256_add_ps(_mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))), _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    inline __m256 Lerp(__m256 a, __m256 b, __m256 t)
+    {
+        return _mm256_add_ps(a, _mm256_mul_ps(_mm256_sub_ps(b, a), t));
+    }
+
+    inline __m256 ImprovedPerlin3D(__m256 x, __m256 y, __m256 z)
+    {
+        const int* p = Density::PermutationTable();
+        auto P = [p](__m256i i) { return _mm256_i32gather_epi32(p, i, 4); };
+        __m256i one = _mm256_set1_epi32(1);
+        __m256i mask = _mm256_set1_epi32(255);
+
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256 fz = _mm256_floor_ps(z);
+        __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), mask);
+        __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), mask);
+        __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(fz), mask);
+        x = _mm256_sub_ps(x, fx);
+        y = _mm256_sub_ps(y, fy);
+        z = _mm256_sub_ps(z, fz);
+        __m256 x1 = _mm256_sub_ps(x, _mm256_set1_ps(1.0f));
+        __m256 y1 = _mm256_sub_ps(y, _mm256_set1_ps(1.0f));
+        __m256 z1 = _mm256_sub_ps(z, _mm256_set1_ps(1.0f));
+        __m256 u = Fade(x), v = Fade(y), w = Fade(z);
+
+        __m256i A = _mm256_add_epi32(P(X), Y);
+        __m256i AA = _mm256_add_epi32(P(A), Z);
+        __m256i AB = _mm256_add_epi32(P(_mm256_add_epi32(A, one)), Z);
+        __m256i B = _mm256_add_epi32(P(_mm256_add_epi32(X, one)), Y);
+        __m256i BA = _mm256_add_epi32(P(B), Z);
+        __m256i BB = _mm256_add_epi32(P(_mm256_add_epi32(B, one)), Z);
+
+        __m256 bottom = Lerp(Lerp(EdgeGradientDot(P(AA), x, y, z), EdgeGradientDot(P(BA), x1, y, z), u),
+                             Lerp(EdgeGradientDot(P(AB), x, y1, z), EdgeGradientDot(P(BB), x1, y1, z), u), v);
+        __m256 top = Lerp(Lerp(EdgeGradientDot(P(_mm256_add_epi32(AA, one)), x, y, z1), EdgeGradientDot(P(_mm256_add_epi32(BA, one)), x1, y, z1), u),
+                          Lerp(EdgeGradientDot(P(_mm256_add_epi32(AB, one)), x, y1, z1), EdgeGradientDot(P(_mm256_add_epi32(BB, one)), x1, y1, z1), u), v);
+        __m256 value = _mm256_mul_ps(Lerp(bottom, top, w), _mm256_set1_ps(Density::permutationContrast));
+        return _mm256_mul_ps(_mm256_add_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+    }
+
+    inline __m256 SimplexGradientDot(__m256i seed, __m256i ip, __m256i jp, __m256i kp, __m256 x, __m256 y, __m256 z)
+    {
+        __m256i hash = _mm256_xor_si256(_mm256_xor_si256(seed, ip), _mm256_xor_si256(jp, kp));
+        hash = _mm256_mullo_epi32(hash, _mm256_set1_epi32(0x27d4eb2d));
+        hash = _mm256_xor_si256(hash, _mm256_srli_epi32(hash, 15));
+        return EdgeGradientDot(hash, x, y, z);
+    }
+
+    // (a * a) * (a * a) * dot WHERE a > 0, 0 ELSEWHERE
+    inline __m256 SimplexKernel(__m256 a, __m256 dot)
+    {
+        __m256 a2 = _mm256_mul_ps(a, a);
+        __m256 term = _mm256_mul_ps(_mm256_mul_ps(a2, a2), dot);
+        return _mm256_and_ps(term, _mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ));
+    }
+
+    // Density::OpenSimplex3D WITH BOTH BRANCHES OF EVERY CHOICE COMPUTED AND BLENDED
+    inline __m256 OpenSimplex3D(__m256 x, __m256 y, __m256 z)
+    {
+        const __m256i primes[3] = { _mm256_set1_epi32(static_cast<int>(Density::simplexPrimeX)), _mm256_set1_epi32(static_cast<int>(Density::simplexPrimeY)), _mm256_set1_epi32(static_cast<int>(Density::simplexPrimeZ)) };
+        __m256 r = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(x, y), z), _mm256_set1_ps(2.0f / 3.0f));
+        __m256 p[3] = { _mm256_sub_ps(r, x), _mm256_sub_ps(r, y), _mm256_sub_ps(r, z) };
+
+        __m256 d[3], ad[3], sign[3];
+        __m256i isign[3], primed[3];
+        for (int axis=0; axis<3; ++axis)
+        {
+            __m256 half = _mm256_blendv_ps(_mm256_set1_ps(0.5f), _mm256_set1_ps(-0.5f), _mm256_cmp_ps(p[axis], _mm256_setzero_ps(), _CMP_LT_OQ));
+            __m256i rounded = _mm256_cvttps_epi32(_mm256_add_ps(p[axis], half));
+            d[axis] = _mm256_sub_ps(p[axis], _mm256_cvtepi32_ps(rounded));
+            isign[axis] = _mm256_or_si256(_mm256_cvttps_epi32(_mm256_sub_ps(_mm256_set1_ps(-1.0f), d[axis])), _mm256_set1_epi32(1));
+            sign[axis] = _mm256_cvtepi32_ps(isign[axis]);
+            ad[axis] = _mm256_mul_ps(sign[axis], _mm256_sub_ps(_mm256_setzero_ps(), d[axis]));
+            primed[axis] = _mm256_mullo_epi32(rounded, primes[axis]);
+        }
+
+        __m256i seed = _mm256_setzero_si256();
+        __m256 value = _mm256_setzero_ps();
+        __m256 a = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.6f), _mm256_mul_ps(d[0], d[0])), _mm256_add_ps(_mm256_mul_ps(d[1], d[1]), _mm256_mul_ps(d[2], d[2])));
+        for (int lattice=0; ; ++lattice)
+        {
+            value = _mm256_add_ps(value, SimplexKernel(a, SimplexGradientDot(seed, primed[0], primed[1], primed[2], d[0], d[1], d[2])));
+
+            // THE SECOND CLOSEST POINT IS ACROSS THE FACE WITH THE LARGEST OFFSET
+            __m256 pickX = _mm256_and_ps(_mm256_cmp_ps(ad[0], ad[1], _CMP_GE_OQ), _mm256_cmp_ps(ad[0], ad[2], _CMP_GE_OQ));
+            __m256 pickY = _mm256_andnot_ps(pickX, _mm256_and_ps(_mm256_cmp_ps(ad[1], ad[0], _CMP_GT_OQ), _mm256_cmp_ps(ad[1], ad[2], _CMP_GE_OQ)));
+            __m256 pickZ = _mm256_andnot_ps(_mm256_or_ps(pickX, pickY), _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+            __m256 picks[3] = { pickX, pickY, pickZ };
+
+            __m256 b = _mm256_add_ps(a, _mm256_set1_ps(1.0f));
+            __m256 d1[3];
+            __m256i primed1[3];
+            for (int axis=0; axis<3; ++axis)
+            {
+                __m256 moved = _mm256_add_ps(d[axis], sign[axis]);
+                __m256 bMoved = _mm256_sub_ps(b, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_slli_epi32(isign[axis], 1)), moved));
+                d1[axis] = _mm256_blendv_ps(d[axis], moved, picks[axis]);
+                primed1[axis] = _mm256_sub_epi32(primed[axis], _mm256_and_si256(_mm256_mullo_epi32(isign[axis], primes[axis]), _mm256_castps_si256(picks[axis])));
+                b = _mm256_blendv_ps(b, bMoved, picks[axis]);
+            }
+            value = _mm256_add_ps(value, SimplexKernel(b, SimplexGradientDot(seed, primed1[0], primed1[1], primed1[2], d1[0], d1[1], d1[2])));
+
+            if (lattice == 1) break;
+
+            // MOVE TO THE SECOND LATTICE, OFFSET BY HALF A CELL ON EVERY AXIS
+            for (int axis=0; axis<3; ++axis)
+            {
+                ad[axis] = _mm256_sub_ps(_mm256_set1_ps(0.5f), ad[axis]);
+                d[axis] = _mm256_mul_ps(sign[axis], ad[axis]);
+                primed[axis] = _mm256_add_epi32(primed[axis], _mm256_and_si256(_mm256_srai_epi32(isign[axis], 1), primes[axis]));
+            }
+            a = _mm256_add_ps(a, _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.75f), ad[0]), _mm256_add_ps(ad[1], ad[2])));
+            for (int axis=0; axis<3; ++axis)
+            {
+                isign[axis] = _mm256_sub_epi32(_mm256_setzero_si256(), isign[axis]);
+                sign[axis] = _mm256_cvtepi32_ps(isign[axis]);
+            }
+            seed = _mm256_xor_si256(seed, _mm256_set1_epi32(-1));
+        }
+        value = _mm256_mul_ps(_mm256_mul_ps(value, _mm256_set1_ps(Density::simplexScale)), _mm256_set1_ps(Density::simplexContrast));
+        return _mm256_mul_ps(_mm256_add_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+    }
+
+    inline __m256 Noise3D(NoiseBackend backend, __m256 x, __m256 y, __m256 z)
+    {
+        switch (backend)
+        {
+            case NoiseBackend::Permutation:  return ImprovedPerlin3D(x, y, z);
+            case NoiseBackend::OpenSimplex2: return OpenSimplex3D(x, y, z);
+            default:                         return Perlin3D(x, y, z);
+        }
+    }
+#else
+    const int lanes = 1;
+#endif
+
+    // RandomGradient3D FOR count LATTICE POINTS - GRADIENTS ARE WRITTEN AS x, y, z TRIPLES
+    // WITH AVX2 THE TAIL ALSO RUNS 8 WIDE, SO EVERY GRADIENT IS THE ONE Perlin3D HASHES FOR ITSELF
+    inline void Gradients3D(const int* ix, const int* iy, const int* iz, float* gradients, int count)
+    {
+#if defined(__AVX2__)
+        for (int i=0; i<count; i += 8) {
+            int lanes = std::min(8, count - i);
+            alignas(32) int px[8] = {}, py[8] = {}, pz[8] = {};
+            std::copy(ix + i, ix + i + lanes, px);
+            std::copy(iy + i, iy + i + lanes, py);
+            std::copy(iz + i, iz + i + lanes, pz);
+            __m256 gx, gy, gz;
+            RandomGradient3D(_mm256_load_si256((const __m256i*)px), _mm256_load_si256((const __m256i*)py), _mm256_load_si256((const __m256i*)pz), gx, gy, gz);
+            alignas(32) float x[8], y[8], z[8];
+            _mm256_store_ps(x, gx);
+            _mm256_store_ps(y, gy);
+            _mm256_store_ps(z, gz);
+            for (int lane=0; lane<lanes; ++lane) {
+                gradients[(i + lane) * 3 + 0] = x[lane];
+                gradients[(i + lane) * 3 + 1] = y[lane];
+                gradients[(i + lane) * 3 + 2] = z[lane];
+            }
+        }
+#else
+        for (int i=0; i<count; ++i) Density::RandomGradient3D(ix[i], iy[i], iz[i], gradients[i * 3], gradients[i * 3 + 1], gradients[i * 3 + 2]);
+#endif
+    }
+
+    // GRADIENTS OF THE LATTICE POINTS AROUND A NOISE SPACE BOX, FOR EVERYTHING EVALUATED OR BOUNDED INSIDE IT
+    struct GradientLattice
+    {
+        int origin[3] = { 0, 0, 0 };
+        int points[3] = { 0, 0, 0 };
+        bool global = true; // MORE THAN maxCells CELLS ON SOME AXIS - NO GRADIENTS WERE BUILT
+        std::vector<float> gradients;
+
+        // EVERY POINT OF [lo, hi] - ITS CELL AND THAT CELL'S FAR CORNERS INCLUDED
+        void Build(const float lo[3], const float hi[3], int maxCells = 1 << 20)
+        {
+            global = false;
+            for (int axis=0; axis<3; ++axis) {
+                origin[axis] = static_cast<int>(std::floor(lo[axis]));
+                points[axis] = static_cast<int>(std::floor(hi[axis])) - origin[axis] + 2;
+                if (points[axis] - 1 > maxCells) global = true;
+            }
+            if (global) return;
+
+            int count = points[0] * points[1] * points[2];
+            thread_local std::vector<int> xs, ys, zs;
+            xs.resize(count);
+            ys.resize(count);
+            zs.resize(count);
+            for (int i=0; i<count; ++i) {
+                xs[i] = origin[0] + i % points[0];
+                ys[i] = origin[1] + i / points[0] % points[1];
+                zs[i] = origin[2] + i / (points[0] * points[1]);
+            }
+            gradients.resize(count * 3);
+            Gradients3D(xs.data(), ys.data(), zs.data(), gradients.data(), count);
+        }
+
+        int Index(int x, int y, int z) const { return x + y * points[0] + z * points[0] * points[1]; }
+    };
+
+    // THE LATTICES OF GetCaveDensity'S FOUR OCTAVES OVER ONE CHUNK'S CORNERS
+    // AT THE 0.05 BASE FREQUENCY A CHUNK OF 12 TOUCHES 2 x 2 x 2 LATTICE POINTS, SO HASHING 8 PER CORNER PER OCTAVE
+    // REPEATS THE SAME FEW GRADIENTS THOUSANDS OF TIMES
+    struct CaveLattices
+    {
+        GradientLattice octaves[4];
+
+        void Build(int chunkX, int chunkY, int chunkZ)
+        {
+            const int size[3] = { ChunkConfig::cornersX, ChunkConfig::cornersY, ChunkConfig::cornersX };
+            const int chunk[3] = { chunkX, chunkY, chunkZ };
+            for (int octave=0; octave<4; ++octave) {
+                // THE SAME FLOAT OPERATIONS AS GetCaveDensity, SO THE BOX HOLDS EVERY CORNER'S NOISE SPACE POSITION
+                float scale = static_cast<float>(1 << octave);
+                float lo[3], hi[3];
+                for (int axis=0; axis<3; ++axis) {
+                    lo[axis] = static_cast<float>(chunk[axis]) * 0.05f * scale;
+                    hi[axis] = static_cast<float>(chunk[axis] + size[axis] - 1) * 0.05f * scale;
+                }
+                octaves[octave].Build(lo, hi);
+            }
+        }
+    };
+
+    // Density::Perlin3D WITH THE GRADIENTS LOOKED UP IN THE LATTICE, WHICH MUST HOLD (x, y, z)
+    inline float Perlin3D(const GradientLattice& lattice, float x, float y, float z)
+    {
+        int x0 = static_cast<int>(std::floor(x));
+        int y0 = static_cast<int>(std::floor(y));
+        int z0 = static_cast<int>(std::floor(z));
+
+        // OFFSETS FROM THE FAR CORNERS ARE TAKEN FROM x ITSELF LIKE DotGridGradient3D - sx - 1 ROUNDS DIFFERENTLY FOR SMALL NEGATIVE x
+        float sx = x - static_cast<float>(x0), sx1 = x - static_cast<float>(x0 + 1);
+        float sy = y - static_cast<float>(y0), sy1 = y - static_cast<float>(y0 + 1);
+        float sz = z - static_cast<float>(z0), sz1 = z - static_cast<float>(z0 + 1);
+
+        const float* g = &lattice.gradients[lattice.Index(x0 - lattice.origin[0], y0 - lattice.origin[1], z0 - lattice.origin[2]) * 3];
+        const int row = lattice.points[0] * 3, slice = lattice.points[0] * lattice.points[1] * 3;
+        auto Dot = [&](int offset, float dx, float dy, float dz) { return g[offset] * dx + g[offset + 1] * dy + g[offset + 2] * dz; };
+
+        float n0 = Dot(0,               sx,  sy,  sz);
+        float n1 = Dot(3,               sx1, sy,  sz);
+        float n2 = Dot(row,             sx,  sy1, sz);
+        float n3 = Dot(row + 3,         sx1, sy1, sz);
+        float n4 = Dot(slice,           sx,  sy,  sz1);
+        float n5 = Dot(slice + 3,       sx1, sy,  sz1);
+        float n6 = Dot(slice + row,     sx,  sy1, sz1);
+        float n7 = Dot(slice + row + 3, sx1, sy1, sz1);
+
+        float iy0 = Density::Interpolate(Density::Interpolate(n0, n1, sx), Density::Interpolate(n2, n3, sx), sy);
+        float iy1 = Density::Interpolate(Density::Interpolate(n4, n5, sx), Density::Interpolate(n6, n7, sx), sy);
+        return (Density::Interpolate(iy0, iy1, sz) + 1.0f) / 2.0f;
+    }
+
+    inline float GetCaveDensity(const CaveLattices& caves, float x, float y, float z)
+    {
+        float sx = x * 0.05f;
+        float sy = y * 0.05f;
+        float sz = z * 0.05f;
+        return Perlin3D(caves.octaves[0], sx, sy, sz)
+        + Perlin3D(caves.octaves[1], sx * 2, sy * 2, sz * 2) * 0.5f
+        + Perlin3D(caves.octaves[2], sx * 4, sy * 4, sz * 4) * 0.25f
+        + Perlin3D(caves.octaves[3], sx * 8, sy * 8, sz * 8) * 0.15f;
+    }
+
+#if defined(__AVX2__)
+    // Perlin3D WITH THE GRADIENTS GATHERED FROM THE LATTICE, WHICH MUST HOLD EVERY LANE'S POINT
+    inline __m256 Perlin3D(const GradientLattice& lattice, __m256 x, __m256 y, __m256 z)
+    {
+        __m256 fx = _mm256_floor_ps(x);
+        __m256 fy = _mm256_floor_ps(y);
+        __m256 fz = _mm256_floor_ps(z);
+        __m256i lx = _mm256_sub_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(lattice.origin[0]));
+        __m256i ly = _mm256_sub_epi32(_mm256_cvttps_epi32(fy), _mm256_set1_epi32(lattice.origin[1]));
+        __m256i lz = _mm256_sub_epi32(_mm256_cvttps_epi32(fz), _mm256_set1_epi32(lattice.origin[2]));
+        __m256i point = _mm256_add_epi32(lx, _mm256_mullo_epi32(_mm256_add_epi32(ly, _mm256_mullo_epi32(lz, _mm256_set1_epi32(lattice.points[1]))), _mm256_set1_epi32(lattice.points[0])));
+        __m256i index = _mm256_mullo_epi32(point, _mm256_set1_epi32(3));
+
+        __m256 sx = _mm256_sub_ps(x, fx);
+        __m256 sy = _mm256_sub_ps(y, fy);
+        __m256 sz = _mm256_sub_ps(z, fz);
+        __m256 sx1 = _mm256_sub_ps(sx, _mm256_set1_ps(1.0f));
+        __m256 sy1 = _mm256_sub_ps(sy, _mm256_set1_ps(1.0f));
+        __m256 sz1 = _mm256_sub_ps(sz, _mm256_set1_ps(1.0f));
+
+        // SAME PRODUCTS AND SUMS AS DotGridGradient3D
+        const float* g = lattice.gradients.data();
+        const int row = lattice.points[0] * 3, slice = lattice.points[0] * lattice.points[1] * 3;
+        auto Dot = [&](int offset, __m256 dx, __m256 dy, __m256 dz) {
+            __m256i i = _mm256_add_epi32(index, _mm256_set1_epi32(offset));
+            __m256 dot = _mm256_mul_ps(_mm256_i32gather_ps(g, i, 4), dx);
+            dot = _mm256_add_ps(dot, _mm256_mul_ps(_mm256_i32gather_ps(g + 1, i, 4), dy));
+            return _mm256_add_ps(dot, _mm256_mul_ps(_mm256_i32gather_ps(g + 2, i, 4), dz));
+        };
+
+        __m256 n0 = Dot(0,               sx,  sy,  sz);
+        __m256 n1 = Dot(3,               sx1, sy,  sz);
+        __m256 n2 = Dot(row,             sx,  sy1, sz);
+        __m256 n3 = Dot(row + 3,         sx1, sy1, sz);
+        __m256 n4 = Dot(slice,           sx,  sy,  sz1);
+        __m256 n5 = Dot(slice + 3,       sx1, sy,  sz1);
+        __m256 n6 = Dot(slice + row,     sx,  sy1, sz1);
+        __m256 n7 = Dot(slice + row + 3, sx1, sy1, sz1);
+
+        __m256 iy0 = Interpolate(Interpolate(n0, n1, sx), Interpolate(n2, n3, sx), sy);
+        __m256 iy1 = Interpolate(Interpolate(n4, n5, sx), Interpolate(n6, n7, sx), sy);
+        __m256 value = Interpolate(iy0, iy1, sz);
+        return _mm256_mul_ps(_mm256_add_ps(value, _mm256_set1_ps(1.0f)), _mm256_set1_ps(0.5f));
+    }
+
+    inline __m256 GetCaveDensity(const CaveLattices& caves, __m256 x, __m256 y, __m256 z)
+    {
+        const float weights[4] = { 1.0f, 0.5f, 0.25f, 0.15f };
+        __m256 sx = _mm256_mul_ps(x, _mm256_set1_ps(0.05f));
+        __m256 sy = _mm256_mul_ps(y, _mm256_set1_ps(0.05f));
+        __m256 sz = _mm256_mul_ps(z, _mm256_set1_ps(0.05f));
+        __m256 density = _mm256_setzero_ps();
+        for (int octave=0; octave<4; ++octave)
+        {
+            __m256 scale = _mm256_set1_ps(static_cast<float>(1 << octave));
+            __m256 noise = Perlin3D(caves.octaves[octave], _mm256_mul_ps(sx, scale), _mm256_mul_ps(sy, scale), _mm256_mul_ps(sz, scale));
+            density = _mm256_add_ps(density, _mm256_mul_ps(noise, _mm256_set1_ps(weights[octave])));
+        }
+        return density;
+    }
+#endif
+
+    // ONE Perlin2D OCTAVE AT (x[i] * frequency, z[i] * frequency) FOR count POINTS
+    inline void Noise2D(const float* x, const float* z, float frequency, float* out, int count)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 scale = _mm256_set1_ps(frequency);
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(out + i, Perlin2D(_mm256_mul_ps(_mm256_loadu_ps(x + i), scale), _mm256_mul_ps(_mm256_loadu_ps(z + i), scale)));
+        }
+#endif
+        for (; i<count; ++i) out[i] = Density::Perlin2D(x[i] * frequency, z[i] * frequency);
+    }
+
+    // ONE OCTAVE OF THE BACKEND'S 3D NOISE AT (x[i], y[i], z[i]) * frequency FOR count POINTS
+    inline void Noise3D(const float* x, const float* y, const float* z, float frequency, float* out, int count, NoiseBackend backend = NoiseBackend::Hash)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 scale = _mm256_set1_ps(frequency);
+        for (; i + 8 <= count; i += 8) {
+            __m256 noise = Noise3D(backend, _mm256_mul_ps(_mm256_loadu_ps(x + i), scale), _mm256_mul_ps(_mm256_loadu_ps(y + i), scale), _mm256_mul_ps(_mm256_loadu_ps(z + i), scale));
+            _mm256_storeu_ps(out + i, noise);
+        }
+#endif
+        for (; i<count; ++i) out[i] = Density::Noise3D(backend, x[i] * frequency, y[i] * frequency, z[i] * frequency);
+    }
+
+    // HASH BACKEND Noise3D WITH THE GRADIENTS FROM lattice, WHICH MUST HOLD EVERY (x[i], y[i], z[i]) * frequency - SAME RESULT, BIT FOR BIT
+    inline void Noise3D(const GradientLattice& lattice, const float* x, const float* y, const float* z, float frequency, float* out, int count)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 scale = _mm256_set1_ps(frequency);
+        for (; i + 8 <= count; i += 8) {
+            __m256 noise = Perlin3D(lattice, _mm256_mul_ps(_mm256_loadu_ps(x + i), scale), _mm256_mul_ps(_mm256_loadu_ps(y + i), scale), _mm256_mul_ps(_mm256_loadu_ps(z + i), scale));
+            _mm256_storeu_ps(out + i, noise);
+        }
+#endif
+        for (; i<count; ++i) out[i] = Perlin3D(lattice, x[i] * frequency, y[i] * frequency, z[i] * frequency);
+    }
+
+    // GetSurfaceHeight FOR count COLUMNS AT WORLD (x[i], z[i])
+    inline void SurfaceHeights(const float* x, const float* z, float* out, int count)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(out + i, GetSurfaceHeight(_mm256_loadu_ps(x + i), _mm256_loadu_ps(z + i)));
+        }
+#endif
+        for (; i<count; ++i) out[i] = Density::GetSurfaceHeight(x[i], z[i]);
+    }
+
+    // BIT i SET WHEN values[i] > threshold - count MUST BE AT MOST 64, MESHERS CLASSIFY WHOLE CORNER ROWS WITH IT
+    inline uint64_t AboveMask(const float* values, int count, float threshold)
+    {
+        uint64_t mask = 0;
+        int i = 0;
+#if defined(__AVX2__)
+        __m256 limit = _mm256_set1_ps(threshold);
+        for (; i + 8 <= count; i += 8) {
+            __m256 above = _mm256_cmp_ps(_mm256_loadu_ps(values + i), limit, _CMP_GT_OQ);
+            mask |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_ps(above))) << i;
+        }
+#endif
+        for (; i<count; ++i) mask |= static_cast<uint64_t>(values[i] > threshold) << i;
+        return mask;
+    }
+
+    // GetDensity FOR count WORLD SPACE CORNERS, GIVEN THE SURFACE HEIGHT OF EACH CORNER'S COLUMN
+    // WITH caves THE CAVE GRADIENTS COME FROM ITS LATTICES, WHICH MUST HOLD EVERY CORNER - SAME RESULT, BIT FOR BIT
+    inline void Densities(const float* x, const float* y, const float* z, const float* surfaceHeight, float* out, int count, const CaveLattices* caves = nullptr)
+    {
+        int i = 0;
+#if defined(__AVX2__)
+        auto cachedCave = [caves](__m256 x, __m256 y, __m256 z) { return GetCaveDensity(*caves, x, y, z); };
+        for (; i + 8 <= count; i += 8) {
+            __m256 px = _mm256_loadu_ps(x + i), py = _mm256_loadu_ps(y + i), pz = _mm256_loadu_ps(z + i), height = _mm256_loadu_ps(surfaceHeight + i);
+            _mm256_storeu_ps(out + i, caves ? GetDensity(px, py, pz, height, cachedCave) : GetDensity(px, py, pz, height));
+        }
+#endif
+        auto cachedCave1 = [caves](float x, float y, float z) { return GetCaveDensity(*caves, x, y, z); };
+        for (; i<count; ++i) {
+            out[i] = caves ? Density::GetDensity(x[i], y[i], z[i], surfaceHeight[i], cachedCave1) : Density::GetDensity(x[i], y[i], z[i], surfaceHeight[i]);
+        }
+    }
+
+    // ADDS THE BRICK'S VALUES TO THE CHUNK CORNERS IT COVERS - EDITS MAY BE NULL
+    inline void AddEdits(const EditBrick* edits, float* out)
+    {
+        using namespace ChunkConfig;
+        if (!edits) return;
+        for (int z = edits->minZ; z < edits->minZ + edits->sizeZ; ++z) {
+            for (int y = edits->minY; y < edits->minY + edits->sizeY; ++y) {
+                for (int x = edits->minX; x < edits->minX + edits->sizeX; ++x) {
+                    if (x < 0 || y < 0 || z < 0 || x >= cornersX || y >= cornersY || z >= cornersX) continue;
+                    out[CornerIndex(x, y, z)] += edits->values[edits->Index(x, y, z)];
+                }
+            }
+        }
+    }
+
+    // EVERY CORNER OF THE CHUNK WHOSE FIRST CORNER IS AT WORLD (chunkX, chunkY, chunkZ), EDITS INCLUDED
+    // out HOLDS ChunkConfig::cornerCount VALUES IN THE SHADER'S DENSITY CACHE ORDER (X FASTEST, THEN Y, THEN Z)
+    // cacheGradients = false HASHES EVERY CAVE LATTICE POINT PER CORNER INSTEAD - SAME OUTPUT, KEPT FOR COMPARISON
+    inline void FillChunk(int chunkX, int chunkY, int chunkZ, const EditBrick* edits, float* out, bool cacheGradients = true)
+    {
+        using namespace ChunkConfig;
+
+        // PADDED TO WHOLE VECTORS SO THE TAIL ALSO RUNS 8 WIDE - PADDING LANES REPEAT THE LAST CORNER
+        const int paddedCount = (cornerCount + 7) / 8 * 8;
+        const int paddedColumns = (cornersX * cornersX + 7) / 8 * 8;
+        thread_local std::vector<float> xs, ys, zs, surface, columnX, columnZ, columnHeight, values;
+        xs.resize(paddedCount);
+        ys.resize(paddedCount);
+        zs.resize(paddedCount);
+        surface.resize(paddedCount);
+        values.resize(paddedCount);
+        columnX.resize(paddedColumns);
+        columnZ.resize(paddedColumns);
+        columnHeight.resize(paddedColumns);
+
+        // SURFACE HEIGHT ONCE PER COLUMN
+        for (int i=0; i<paddedColumns; ++i) {
+            int column = std::min(i, cornersX * cornersX - 1);
+            columnX[i] = static_cast<float>(chunkX + column % cornersX);
+            columnZ[i] = static_cast<float>(chunkZ + column / cornersX);
+        }
+        SurfaceHeights(columnX.data(), columnZ.data(), columnHeight.data(), paddedColumns);
+
+        for (int i=0; i<paddedCount; ++i) {
+            int corner = std::min(i, cornerCount - 1);
+            int x = corner % cornersX;
+            int y = corner / cornersX % cornersY;
+            int z = corner / (cornersX * cornersY);
+            xs[i] = static_cast<float>(chunkX + x);
+            ys[i] = static_cast<float>(chunkY + y);
+            zs[i] = static_cast<float>(chunkZ + z);
+            surface[i] = columnHeight[x + z * cornersX];
+        }
+
+        // CAVE GRADIENTS ONCE PER CHUNK, IF ANY CORNER REACHES DOWN INTO THE BLEND BAND
+        thread_local CaveLattices caves;
+        float blendTop = -1e30f;
+        for (int i=0; i<cornersX * cornersX; ++i) blendTop = std::max(blendTop, columnHeight[i] * Density::surfaceScale + Density::blendDistance);
+        bool cached = cacheGradients && static_cast<float>(chunkY) < blendTop;
+        if (cached) caves.Build(chunkX, chunkY, chunkZ);
+
+        Densities(xs.data(), ys.data(), zs.data(), surface.data(), values.data(), paddedCount, cached ? &caves : nullptr);
+
+        std::copy(values.begin(), values.begin() + cornerCount, out);
+        AddEdits(edits, out);
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef EDIT_OVERLAY_H
+#define EDIT_OVERLAY_H
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "density.h"
+
+/*
+Terrain edits for one chunk, added on top of the procedural density.
+Nothing is allocated until the chunk is first edited, after that only the box of corners that has actually
+been edited (the brick) is stored. Bricks are shared copy-on-write: jobs in the pipeline hold a snapshot
+while the chunk keeps being edited on the main thread.
+*/
+
+struct EditBrick
+{
+    int minX = 0, minY = 0, minZ = 0;
+    int sizeX = 0, sizeY = 0, sizeZ = 0;
+    std::vector<float> values;
+
+    bool Contains(int x, int y, int z) const
+    {
+        return x >= minX && x < minX + sizeX &&
+               y >= minY && y < minY + sizeY &&
+               z >= minZ && z < minZ + sizeZ;
+    }
+
+    int Index(int x, int y, int z) const
+    {
+        return (x - minX) + (y - minY) * sizeX + (z - minZ) * sizeX * sizeY;
+    }
+
+    float Get(int x, int y, int z) const
+    {
+        return Contains(x, y, z) ? values[Index(x, y, z)] : 0.0f;
+    }
+
+    // RANGE OF EDIT VALUES - ALWAYS INCLUDES 0 FOR THE CORNERS OUTSIDE THE BRICK
+    Density::Interval Range() const
+    {
+        Density::Interval range = { 0.0f, 0.0f };
+        for (float value : values) {
+            range.min = std::min(range.min, value);
+            range.max = std::max(range.max, value);
+        }
+        return range;
+    }
+};
+
+class EditOverlay
+{
+public:
+    bool Empty() const { return brick == nullptr; }
+
+    // X, Y, Z ARE LOCAL CORNER COORDINATES
+    void Add(int x, int y, int z, float amount)
+    {
+        EditBrick& writable = Writable(x, y, z);
+        writable.values[writable.Index(x, y, z)] += amount;
+        dirty = true;
+    }
+
+    float Get(int x, int y, int z) const
+    {
+        return brick ? brick->Get(x, y, z) : 0.0f;
+    }
+
+    // IMMUTABLE VIEW FOR THE PIPELINE - LATER EDITS COPY THE BRICK INSTEAD OF CHANGING THE SNAPSHOT
+    std::shared_ptr<const EditBrick> Snapshot() const { return brick; }
+
+    void Clear() 
+    { 
+        brick.reset(); 
+        dirty = false;
+    }
+
+    // EDITS LOADED FROM DISK ARE NOT DIRTY, EDITS RESTORED FROM THE CHUNK CACHE MAY NOT HAVE BEEN SAVED YET
+    void Restore(std::shared_ptr<EditBrick> restored, bool restoredDirty = false)
+    {
+        brick = restored;
+        dirty = restored && restoredDirty;
+    }
+
+    // HANDS THE BRICK OVER AND LEAVES THE OVERLAY EMPTY
+    std::shared_ptr<EditBrick> Release()
+    {
+        dirty = false;
+        return std::move(brick);
+    }
+
+    // TRUE WHEN THE EDITS HAVE CHANGED SINCE THEY WERE LOADED OR SAVED
+    bool Dirty() const { return dirty; }
+    void MarkSaved() { dirty = false; }
+
+    size_t MemoryBytes() const
+    {
+        return brick ? sizeof(EditBrick) + brick->values.size() * sizeof(float) : 0;
+    }
+
+private:
+    std::shared_ptr<EditBrick> brick;
+    bool dirty = false;
+
+    // GROWS THE BRICK TO COVER (X, Y, Z) AND MAKES SURE NO SNAPSHOT SHARES IT
+    EditBrick& Writable(int x, int y, int z)
+    {
+        if (brick && brick->Contains(x, y, z))
+        {
+            if (brick.use_count() > 1) brick = std::make_shared<EditBrick>(*brick);
+            return *brick;
+        }
+
+        std::shared_ptr<EditBrick> grown = std::make_shared<EditBrick>();
+        int maxX = x, maxY = y, maxZ = z;
+        grown->minX = x;
+        grown->minY = y;
+        grown->minZ = z;
+        if (brick)
+        {
+            grown->minX = std::min(x, brick->minX);
+            grown->minY = std::min(y, brick->minY);
+            grown->minZ = std::min(z, brick->minZ);
+            maxX = std::max(x, brick->minX + brick->sizeX - 1);
+            maxY = std::max(y, brick->minY + brick->sizeY - 1);
+            maxZ = std::max(z, brick->minZ + brick->sizeZ - 1);
+        }
+        grown->sizeX = maxX - grown->minX + 1;
+        grown->sizeY = maxY - grown->minY + 1;
+        grown->sizeZ = maxZ - grown->minZ + 1;
+        grown->values = std::vector<float>(grown->sizeX * grown->sizeY * grown->sizeZ, 0.0f);
+
+        // COPY THE OLD BRICK INTO THE GROWN ONE
+        if (brick)
+        {
+            for (int bz = brick->minZ; bz < brick->minZ + brick->sizeZ; ++bz) {
+                for (int by = brick->minY; by < brick->minY + brick->sizeY; ++by) {
+                    for (int bx = brick->minX; bx < brick->minX + brick->sizeX; ++bx) {
+                        grown->values[grown->Index(bx, by, bz)] = brick->values[brick->Index(bx, by, bz)];
+                    }
+                }
+            }
+        }
+
+        brick = grown;
+        return *brick;
+    }
+};
+
+#endif
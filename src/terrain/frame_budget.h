@@ -0,0 +1,62 @@
+#ifndef FRAME_BUDGET_H
+#define FRAME_BUDGET_H
+
+#include <chrono>
+
+/*
+Per frame time budget for terrain work.
+Each stage keeps a running average of what one unit of its work costs on this machine,
+and the terrain system keeps taking work while the predicted cost still fits in what is left of the budget.
+*/
+
+struct StageCost
+{
+    double averageMs;
+    StageCost(double initialEstimateMs) : averageMs(initialEstimateMs) {}
+
+    void Record(double elapsedMs, int units)
+    {
+        if (units <= 0) return;
+        const double smoothing = 0.1;
+        averageMs += ((elapsedMs / units) - averageMs) * smoothing;
+    }
+};
+
+class FrameBudget
+{
+public:
+    double budgetMs = 4.0; // <= 0 DISABLES THE BUDGET - FIXED CHUNK COUNTS ARE USED INSTEAD
+
+    // MAIN THREAD STAGE COSTS PER CHUNK
+    StageCost unloadCost{0.01};
+    StageCost dispatchCost{0.25};
+    StageCost readbackCost{0.25};
+
+    bool Enabled() const { return budgetMs > 0.0; }
+
+    void BeginFrame() { frameStart = std::chrono::high_resolution_clock::now(); }
+
+    double ElapsedMs() const { return MillisecondsSince(frameStart); }
+
+    // TRUE WHEN WORK PREDICTED TO TAKE PREDICTEDMS STILL FITS IN THIS FRAME
+    bool CanAfford(double predictedMs) const
+    {
+        return ElapsedMs() + predictedMs <= budgetMs;
+    }
+
+    static std::chrono::time_point<std::chrono::high_resolution_clock> Now()
+    {
+        return std::chrono::high_resolution_clock::now();
+    }
+
+    static double MillisecondsSince(std::chrono::time_point<std::chrono::high_resolution_clock> start)
+    {
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(Now() - start);
+        return duration.count() / 1e6;
+    }
+
+private:
+    std::chrono::time_point<std::chrono::high_resolution_clock> frameStart;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+
+/*
+Small fixed size thread pool used by the terrain pipeline.
+Tasks are plain closures, results travel back to the main thread through a CompletionQueue.
+Pending tasks are discarded on shutdown - anything still queued belongs to a terrain system that is being destroyed.
+*/
+
+class WorkerPool
+{
+public:
+    WorkerPool(int threadCount = 0)
+    {
+        if (threadCount <= 0) {
+            threadCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+        }
+        for (int i=0; i<threadCount; ++i) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            tasks.clear();
+        }
+        condition.notify_all();
+        for (std::thread& worker : workers) worker.join();
+    }
+
+    void Submit(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        condition.notify_one();
+    }
+
+    int ThreadCount() const { return static_cast<int>(workers.size()); }
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+
+    void WorkerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                condition.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (stopping) return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+template <typename T>
+class CompletionQueue
+{
+public:
+    void Push(T item)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        items.push_back(std::move(item));
+    }
+
+    // MOVES EVERY COMPLETED ITEM INTO OUT - NEVER BLOCKS ON WORKERS FOR LONGER THAN A PUSH
+    void PopAll(std::vector<T>& out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (T& item : items) out.push_back(std::move(item));
+        items.clear();
+    }
+
+private:
+    std::vector<T> items;
+    std::mutex mutex;
+};
+
+#endif
@@ -0,0 +1,648 @@
+#ifndef MARCHING_CUBES_CPU_H
+#define MARCHING_CUBES_CPU_H
+
+#include "../vendor/glm/glm.hpp"
+#include "chunk_config.h"
+#include "chunk_job.h"
+#include "job_system.h"
+#include "tables.h"
+#include "density_graph.h"
+#include "density_multires.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+
+/*
+Marching cubes on the worker pool - the meshes of TerrainGPU without an OpenGL context, for headless tools and
+machines without a usable GPU. Same Dispatch / Poll interface, same output in ChunkJob::rawVertices and rawIndices.
+Each chunk is cut into slabs of cell layers along z, and the slabs of every dispatched chunk are queued on the pool.
+Every step runs on all slabs of a chunk, and the slab that finishes a step last starts the next one:
+1. DENSITY: each slab evaluates its corner layers through the world's compiled density graph - or, in multi-resolution
+   mode, one task fills a whole LOD 0 chunk with its low frequency octaves on coarser grids (density_multires.h)
+2. CLASSIFY: each slab compares whole corner rows with the threshold (8 corners per instruction with AVX2) into bit
+   masks, from which the crossed edges, the cube index of every cell and the triangle counts follow with bit operations
+3. an exclusive prefix sum of the row counts gives every row its exact place in the output, which is allocated once,
+   and the LOD transition faces are added at its end
+4. EMIT: each slab writes its vertices and triangles straight into the output - cells are visited through the bits
+   of their row's non-empty mask, so empty and full cells cost nothing
+A vertex's index follows from the masks alone (its row's offset plus the crossings before it in the row), so triangles
+never wait for another slab's vertices. Vertices, normals and transition faces follow the compute shader step for step.
+*/
+
+class TerrainCPU
+{
+public:
+    static constexpr int width = ChunkConfig::width;
+    static constexpr int height = ChunkConfig::height;
+    static constexpr int slabCells = 4; // CELL LAYERS PER SLAB TASK
+
+    static_assert(width < 64, "CORNER ROWS ARE 64 BIT MASKS");
+
+    // pool MUST OUTLIVE THIS MESHER - TASKS STILL QUEUED WHEN IT SHUTS DOWN ARE DROPPED
+    TerrainCPU(WorkerPool& pool, const TerrainShape& shape = DefaultTerrainShape()) : pool(pool), density(shape.density), boundedShape(shape.bounded) {}
+
+    // LOD 0 DENSITIES WITHIN maxError OF THE EXACT ONES, THE LOW FREQUENCY OCTAVES SAMPLED ON COARSER GRIDS - 0 TURNS IT OFF
+    // ONLY FOR THE DEFAULT SHAPE, WHICH FillChunkMultiResolution HARD CODES. RETURNS THE ERROR BOUND OF THE CHOSEN STRIDES
+    // CALL IT BEFORE THE FIRST Dispatch
+    float SetMultiResolution(float maxError)
+    {
+        multiResolution = maxError > 0.0f && boundedShape;
+        strides = DensitySIMD::ChooseStrides(multiResolution ? maxError : 0.0f);
+        return strides.error;
+    }
+
+    // QUEUES EVERY SLAB OF THE JOBS ON THE POOL - DOES NOT WAIT FOR THEM
+    void Dispatch(std::vector<std::shared_ptr<ChunkJob>>& jobs)
+    {
+        if (jobs.empty()) return;
+
+        std::shared_ptr<std::atomic<int>> batch = std::make_shared<std::atomic<int>>(static_cast<int>(jobs.size()));
+        batches.push_back(batch);
+
+        for (std::shared_ptr<ChunkJob>& job : jobs)
+        {
+            std::shared_ptr<MeshTask> task = std::make_shared<MeshTask>();
+            task->job = job;
+            task->batch = batch;
+            task->stride = 1 << job->lod;
+            task->cells[0] = width / task->stride;
+            task->cells[1] = height / task->stride;
+            task->cells[2] = width / task->stride;
+            task->slabCount = (task->cells[2] + slabCells - 1) / slabCells;
+            task->densities.resize((task->cells[0] + 1) * (task->cells[1] + 1) * (task->cells[2] + 1));
+            task->rows.resize((task->cells[1] + 1) * (task->cells[2] + 1));
+            task->activeRows = ActiveCellRows(*job, task->cells[1], task->cells[2], task->stride);
+            FindSampledRows(*task);
+
+            auto mesh = [this](std::shared_ptr<MeshTask> task) {
+                BlendTransitionFaces(*task);
+                ForEachSlab(task, &TerrainCPU::ClassifySlab, [this](std::shared_ptr<MeshTask> task) {
+                    AllocateOutput(*task);
+                    ForEachSlab(task, &TerrainCPU::EmitSlab, [this](std::shared_ptr<MeshTask> task) { Finish(*task); });
+                });
+            };
+
+            // THE COARSE OCTAVES SPAN THE WHOLE CHUNK, SO A MULTI-RESOLUTION FILL IS ONE TASK
+            if (multiResolution && job->lod == 0)
+            {
+                pool.Submit([this, task, mesh] {
+                    if (!task->job->cancelled) FillChunkMultiResolution(*task);
+                    if (task->job->cancelled) Finish(*task);
+                    else mesh(task);
+                });
+            }
+            else ForEachSlab(task, &TerrainCPU::FillSlab, mesh);
+        }
+    }
+
+    // COLLECTS EVERY JOB THE WORKERS HAVE FINISHED MESHING - NEVER BLOCKS
+    void Poll(std::vector<std::shared_ptr<ChunkJob>>& finishedJobs)
+    {
+        std::vector<std::shared_ptr<ChunkJob>> meshed;
+        completedJobs.PopAll(meshed);
+        for (std::shared_ptr<ChunkJob>& job : meshed) {
+            if (!job->cancelled) finishedJobs.push_back(job);
+        }
+        batches.erase(std::remove_if(batches.begin(), batches.end(),
+            [](const std::shared_ptr<std::atomic<int>>& batch) { return *batch == 0; }), batches.end());
+    }
+
+    int BatchesInFlight() const
+    {
+        return static_cast<int>(std::count_if(batches.begin(), batches.end(),
+            [](const std::shared_ptr<std::atomic<int>>& batch) { return *batch > 0; }));
+    }
+
+    float DensityThreshold() const { return densityThreshold; }
+
+private:
+    float densityThreshold = 0.7f; // SAME AS TerrainGPU
+
+    // CORNER OFFSETS IN CELLS - THE ORDER TriTable AND THE EDGE TABLES USE
+    static constexpr int cornerOffsets[8][3] = {
+        {0, 0, 1}, {1, 0, 1}, {1, 0, 0}, {0, 0, 0},
+        {0, 1, 1}, {1, 1, 1}, {1, 1, 0}, {0, 1, 0} };
+
+    // ONE ROW OF LOD CORNERS ALONG X, AND THE ROW OF CELLS STARTING AT IT - BIT x IS CORNER OR CELL x
+    struct CornerRow
+    {
+        uint64_t above = 0;      // CORNERS ABOVE THE DENSITY THRESHOLD
+        uint64_t crossed[3] = {}; // CORNERS WHOSE +X +Y +Z EDGE THE SURFACE CROSSES
+        uint64_t cells = 0;      // CELLS WITH CORNERS ON BOTH SIDES
+        int vertexCount = 0;
+        int indexCount = 0;
+        int firstVertex = 0;     // PLACE IN THE OUTPUT, FROM THE PREFIX SUM
+        int firstIndex = 0;
+    };
+
+    // ONE CHUNK ON THE WORKERS - SHARED BY ITS SLAB TASKS
+    struct MeshTask
+    {
+        std::shared_ptr<ChunkJob> job;
+        std::shared_ptr<std::atomic<int>> batch;
+        int stride = 1;
+        int cells[3] = { 0, 0, 0 }; // PER AXIS AT THIS LOD
+        int slabCount = 1;
+        std::vector<float> densities; // ONE PER LOD CORNER, X FASTEST - TRANSITION FACES ALREADY BLENDED
+        std::vector<CornerRow> rows;  // ONE PER (Y, Z), Y FASTEST
+        std::vector<char> activeRows;  // ONE PER CELL ROW (Y, Z), Y FASTEST - SEE ActiveCellRows
+        std::vector<char> sampledRows; // ONE PER CORNER ROW - THE ROWS ACTIVE CELLS AND THEIR NORMALS READ, THE ONLY ONES EVALUATED
+        std::vector<unsigned int> transitionIndices;
+        std::atomic<int> remaining{0}; // SLABS STILL RUNNING THE CURRENT STEP
+
+        // LOD CORNER (IN CELLS OF THIS LOD)
+        int Lattice(int x, int y, int z) const { return x + (y + z * (cells[1] + 1)) * (cells[0] + 1); }
+        float Density(const int l[3]) const { return densities[Lattice(l[0], l[1], l[2])]; }
+        CornerRow& Row(int y, int z) { return rows[y + z * (cells[1] + 1)]; }
+        const CornerRow& Row(int y, int z) const { return rows[y + z * (cells[1] + 1)]; }
+        bool Active(int y, int z) const { return y >= 0 && z >= 0 && y < cells[1] && z < cells[2] && activeRows[y + z * cells[1]]; }
+        bool Sampled(int y, int z) const { return sampledRows[y + z * (cells[1] + 1)]; }
+
+        // CORNER LAYERS z0 <= z < z1 OF SLAB s - THE LAST SLAB ALSO HAS THE TOP LAYER
+        void CornerLayers(int s, int& z0, int& z1) const
+        {
+            z0 = s * slabCells;
+            z1 = s == slabCount - 1 ? cells[2] + 1 : z0 + slabCells;
+        }
+
+        // INDEX OF THE VERTEX ON THE EDGE FROM LOD CORNER l ALONG axis - ITS ROW'S FIRST VERTEX PLUS THE CROSSINGS BEFORE IT,
+        // IN THE ORDER EmitSlab WRITES THEM (X ASCENDING, THEN AXIS)
+        unsigned int VertexIndex(const int l[3], int axis) const
+        {
+            const CornerRow& row = Row(l[1], l[2]);
+            uint64_t before = (uint64_t(1) << l[0]) - 1;
+            uint64_t here = uint64_t(1) << l[0];
+            int index = row.firstVertex;
+            for (int a=0; a<3; ++a) index += std::popcount(row.crossed[a] & before);
+            for (int a=0; a<axis; ++a) index += (row.crossed[a] & here) != 0;
+            return static_cast<unsigned int>(index);
+        }
+
+        // THE EDGE FROM LOD CORNER a TO ITS NEIGHBOUR b ALONG ONE AXIS, IN EITHER ORDER
+        unsigned int EdgeVertex(const int a[3], const int b[3]) const
+        {
+            int axis = a[0] != b[0] ? 0 : (a[1] != b[1] ? 1 : 2);
+            int lower[3] = { std::min(a[0], b[0]), std::min(a[1], b[1]), std::min(a[2], b[2]) };
+            return VertexIndex(lower, axis);
+        }
+    };
+
+    WorkerPool& pool;
+    DensityKernel density;
+    bool boundedShape;            // THE DEFAULT SHAPE - THE ONLY ONE MULTI-RESOLUTION FILLS CAN EVALUATE
+    bool multiResolution = false;
+    DensitySIMD::OctaveStrides strides;
+    std::vector<std::shared_ptr<std::atomic<int>>> batches; // JOBS OF EACH DISPATCH STILL ON THE WORKERS
+    CompletionQueue<std::shared_ptr<ChunkJob>> completedJobs;
+
+    // TRIANGLES OF EACH CUBE INDEX
+    static const uint8_t* TriangleCounts()
+    {
+        struct Counts
+        {
+            uint8_t values[256];
+            Counts()
+            {
+                for (int c=0; c<256; ++c) {
+                    int i = 0;
+                    while (TriTable[c][i] != -1) i += 1;
+                    values[c] = static_cast<uint8_t>(i / 3);
+                }
+            }
+        };
+        static const Counts counts;
+        return counts.values;
+    }
+
+    // RUNS step ON EVERY SLAB, THEN then ON THE WORKER THAT FINISHES THE LAST ONE - A CANCELLED JOB SKIPS STRAIGHT TO Finish
+    template <typename Then>
+    void ForEachSlab(std::shared_ptr<MeshTask> task, void (TerrainCPU::*step)(MeshTask&, int), Then then)
+    {
+        task->remaining = task->slabCount;
+        for (int s=0; s<task->slabCount; ++s)
+        {
+            pool.Submit([this, task, s, step, then] {
+                if (!task->job->cancelled) (this->*step)(*task, s);
+                if (task->remaining.fetch_sub(1) != 1) return;
+                if (task->job->cancelled) Finish(*task);
+                else then(task);
+            });
+        }
+    }
+
+    // CORNER ROWS OF THE ACTIVE CELL ROWS, AND ONE MORE ON EACH SIDE FOR THE CENTRAL DIFFERENCES OF THEIR NORMALS
+    static void FindSampledRows(MeshTask& t)
+    {
+        t.sampledRows.assign(t.rows.size(), 0);
+        for (int z=0; z<t.cells[2]; ++z) {
+            for (int y=0; y<t.cells[1]; ++y)
+            {
+                if (!t.Active(y, z)) continue;
+                for (int rz=std::max(z - 1, 0); rz<=std::min(z + 2, t.cells[2]); ++rz)
+                    for (int ry=std::max(y - 1, 0); ry<=std::min(y + 2, t.cells[1]); ++ry) t.sampledRows[ry + rz * (t.cells[1] + 1)] = 1;
+            }
+        }
+    }
+
+    // STEP 1 - DENSITIES OF THE SLAB'S SAMPLED CORNER ROWS - THE OTHERS ARE NEVER READ
+    void FillSlab(MeshTask& t, int s)
+    {
+        ChunkJob& job = *t.job;
+        int z0, z1;
+        t.CornerLayers(s, z0, z1);
+        int rowLength = t.cells[0] + 1;
+        thread_local std::vector<int> sampled;
+        sampled.clear();
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<=t.cells[1]; ++y) {
+                if (t.Sampled(y, z)) sampled.push_back(t.Lattice(0, y, z));
+            }
+        }
+        if (sampled.empty()) return;
+
+        int count = static_cast<int>(sampled.size()) * rowLength;
+        thread_local std::vector<float> xs, ys, zs, surface, values;
+        xs.resize(count);
+        ys.resize(count);
+        zs.resize(count);
+        surface.resize(count);
+        values.resize(count);
+
+        const float* heights = job.surface->Values();
+        for (int r=0, i=0; r<static_cast<int>(sampled.size()); ++r)
+        {
+            int y = sampled[r] / rowLength % (t.cells[1] + 1);
+            int z = sampled[r] / rowLength / (t.cells[1] + 1);
+            for (int x=0; x<=t.cells[0]; ++x, ++i) {
+                xs[i] = static_cast<float>(job.x + x * t.stride);
+                ys[i] = static_cast<float>(job.y + y * t.stride);
+                zs[i] = static_cast<float>(job.z + z * t.stride);
+                surface[i] = heights[x * t.stride + z * t.stride * ChunkConfig::cornersX];
+            }
+        }
+        // THE BOX IS THE WHOLE SLAB'S, SKIPPED ROWS OR NOT - CAVE GRADIENTS COME FROM ITS LATTICES
+        const float lo[3] = { static_cast<float>(job.x), static_cast<float>(job.y), static_cast<float>(job.z + z0 * t.stride) };
+        const float hi[3] = { static_cast<float>(job.x + t.cells[0] * t.stride), static_cast<float>(job.y + t.cells[1] * t.stride),
+                              static_cast<float>(job.z + (z1 - 1) * t.stride) };
+        density.EvaluateInBox(xs.data(), ys.data(), zs.data(), surface.data(), values.data(), count, lo, hi);
+
+        // ROWS ARE CONTIGUOUS IN THE LATTICE - EDITS ARE ADDED CORNER BY CORNER
+        for (int r=0; r<static_cast<int>(sampled.size()); ++r)
+        {
+            float* out = &t.densities[sampled[r]];
+            std::memcpy(out, &values[r * rowLength], rowLength * sizeof(float));
+            if (!job.edits) continue;
+            int y = sampled[r] / rowLength % (t.cells[1] + 1);
+            int z = sampled[r] / rowLength / (t.cells[1] + 1);
+            for (int x=0; x<=t.cells[0]; ++x) out[x] += job.edits->Get(x * t.stride, y * t.stride, z * t.stride);
+        }
+    }
+
+    // STEP 1 IN MULTI-RESOLUTION MODE - EVERY CORNER OF A LOD 0 CHUNK, EDITS INCLUDED
+    void FillChunkMultiResolution(MeshTask& t)
+    {
+        ChunkJob& job = *t.job;
+        DensitySIMD::FillChunkMultiResolution(job.x, job.y, job.z, job.edits.get(), t.densities.data(), strides);
+    }
+
+    // A FACE BIT (ORDER -X +X -Y +Y -Z +Z) IS SET WHEN THE NEIGHBOUR ACROSS THAT FACE IS ONE LEVEL COARSER
+    static bool OnTransitionFace(const MeshTask& t, const int l[3])
+    {
+        int mask = t.job->transitionMask;
+        for (int axis=0; axis<3; ++axis) {
+            if ((mask & (1 << (axis * 2))) != 0 && l[axis] == 0) return true;
+            if ((mask & (1 << (axis * 2 + 1))) != 0 && l[axis] == t.cells[axis]) return true;
+        }
+        return false;
+    }
+
+    // SAMPLES ON A TRANSITION FACE WHICH THE COARSE NEIGHBOUR DOESN'T HAVE BECOME ITS INTERPOLATION OF THEM, AS IN GetLodDensity
+    // THEY ONLY READ SAMPLES WITH EVEN COORDINATES, WHICH ARE NEVER REPLACED, SO THIS WORKS IN PLACE
+    static void BlendTransitionFaces(MeshTask& t)
+    {
+        if (t.job->transitionMask == 0) return;
+        for (int z=0; z<=t.cells[2]; ++z) {
+            for (int y=0; y<=t.cells[1]; ++y) {
+                for (int x=0; x<=t.cells[0]; ++x)
+                {
+                    int l[3] = { x, y, z };
+                    int odd[3] = { x % 2, y % 2, z % 2 };
+                    if (odd[0] + odd[1] + odd[2] == 0 || !OnTransitionFace(t, l)) continue;
+
+                    float sum = 0.0f;
+                    int count = 0;
+                    for (int i=0; i<8; ++i)
+                    {
+                        int corner[3] = { i & 1, (i >> 1) & 1, (i >> 2) & 1 };
+                        if (corner[0] > odd[0] || corner[1] > odd[1] || corner[2] > odd[2]) continue;
+                        int q[3];
+                        for (int a=0; a<3; ++a) q[a] = l[a] + (corner[a] * 2 - 1) * odd[a];
+                        sum += t.Density(q);
+                        count += 1;
+                    }
+                    t.densities[t.Lattice(x, y, z)] = sum / count;
+                }
+            }
+        }
+    }
+
+    // STEP 2 - MASKS AND COUNTS OF THE SLAB'S CORNER ROWS, EACH ROW'S CELLS INCLUDED
+    void ClassifySlab(MeshTask& t, int s)
+    {
+        int z0, z1;
+        t.CornerLayers(s, z0, z1);
+        int rowLength = t.cells[0] + 1;
+        uint64_t cornerBits = (uint64_t(1) << rowLength) - 1;
+        uint64_t cellBits = cornerBits >> 1;
+
+        // THE NEXT SLAB'S FIRST LAYER IS NEEDED FOR THE +Z EDGES AND THE TOP CELLS - ITS MASKS ARE RECOMPUTED HERE
+        int zEnd = std::min(z1 + 1, t.cells[2] + 1);
+        thread_local std::vector<uint64_t> above;
+        above.resize((t.cells[1] + 1) * (zEnd - z0));
+        for (int z=z0; z<zEnd; ++z) {
+            for (int y=0; y<=t.cells[1]; ++y) {
+                if (!t.Sampled(y, z)) above[y + (z - z0) * (t.cells[1] + 1)] = 0;
+                else above[y + (z - z0) * (t.cells[1] + 1)] = DensitySIMD::AboveMask(&t.densities[t.Lattice(0, y, z)], rowLength, densityThreshold);
+            }
+        }
+
+        const uint8_t* triangleCounts = TriangleCounts();
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<=t.cells[1]; ++y)
+            {
+                CornerRow& row = t.Row(y, z);
+                uint64_t a0 = above[y + (z - z0) * (t.cells[1] + 1)];
+                uint64_t a1 = z < t.cells[2] ? above[y + (z + 1 - z0) * (t.cells[1] + 1)] : a0;  // +Z
+                uint64_t b0 = y < t.cells[1] ? above[y + 1 + (z - z0) * (t.cells[1] + 1)] : a0; // +Y
+                uint64_t b1 = y < t.cells[1] && z < t.cells[2] ? above[y + 1 + (z + 1 - z0) * (t.cells[1] + 1)] : a0;
+                row.above = a0;
+
+                // AN EDGE IS MESHED BY THE CELLS AROUND IT - ONE IN ROWS THE BOUNDS RULED OUT HAS NO CROSSING, EXCEPT ON
+                // TRANSITION FACES, WHICH ActiveCellRows KEEPS, SO THE ROWS ARE SKIPPED AND THEIR DENSITIES NEVER FILLED
+                bool sideX = t.Active(y - 1, z - 1) || t.Active(y, z - 1) || t.Active(y - 1, z) || t.Active(y, z);
+                bool sideY = t.Active(y, z - 1) || t.Active(y, z);
+                bool sideZ = t.Active(y - 1, z) || t.Active(y, z);
+                row.crossed[0] = sideX ? (a0 ^ (a0 >> 1)) & cellBits : 0;
+                row.crossed[1] = sideY ? a0 ^ b0 : 0;
+                row.crossed[2] = sideZ ? a0 ^ a1 : 0;
+                row.vertexCount = std::popcount(row.crossed[0]) + std::popcount(row.crossed[1]) + std::popcount(row.crossed[2]);
+
+                // A CELL IS EMPTY OR FULL WHEN ITS 8 CORNERS AGREE - ALL 4 ROWS, BOTH ENDS
+                row.cells = 0;
+                row.indexCount = 0;
+                if (!t.Active(y, z)) continue;
+                uint64_t any = a0 | a1 | b0 | b1;
+                uint64_t all = a0 & a1 & b0 & b1;
+                row.cells = ((any | (any >> 1)) & ~(all & (all >> 1))) & cellBits;
+                for (uint64_t cells = row.cells; cells != 0; cells &= cells - 1) {
+                    row.indexCount += triangleCounts[CubeIndex(a0, a1, b0, b1, std::countr_zero(cells))] * 3;
+                }
+            }
+        }
+    }
+
+    // CUBE INDEX OF CELL x FROM THE ABOVE MASKS OF ITS 4 CORNER ROWS - BIT i IS CORNER i OF cornerOffsets
+    static int CubeIndex(uint64_t a0, uint64_t a1, uint64_t b0, uint64_t b1, int x)
+    {
+        return static_cast<int>(((a1 >> x) & 1) | ((a1 >> x >> 1 & 1) << 1) | ((a0 >> x >> 1 & 1) << 2) | ((a0 >> x & 1) << 3) |
+                                ((b1 >> x & 1) << 4) | ((b1 >> x >> 1 & 1) << 5) | ((b0 >> x >> 1 & 1) << 6) | ((b0 >> x & 1) << 7));
+    }
+
+    // STEP 3 - EXCLUSIVE PREFIX SUM OF THE ROW COUNTS, TRANSITION FACES AT THE END, ONE ALLOCATION
+    void AllocateOutput(MeshTask& t)
+    {
+        int vertexCount = 0;
+        int indexCount = 0;
+        for (CornerRow& row : t.rows)
+        {
+            row.firstVertex = vertexCount;
+            row.firstIndex = indexCount;
+            vertexCount += row.vertexCount;
+            indexCount += row.indexCount;
+        }
+
+        // LOD TRANSITION FACES - ONE COARSE SQUARE PER 2 X 2 CELLS OF EACH FACE
+        t.transitionIndices.clear();
+        for (int face=0; face<6; ++face)
+        {
+            if ((t.job->transitionMask & (1 << face)) == 0) continue;
+            int axis = face / 2;
+            int u = (axis + 1) % 3;
+            int v = (axis + 2) % 3;
+            for (int cv=0; cv<t.cells[v]; cv+=2) {
+                for (int cu=0; cu<t.cells[u]; cu+=2)
+                {
+                    int origin[3];
+                    origin[axis] = face % 2 == 0 ? 0 : t.cells[axis];
+                    origin[u] = cu;
+                    origin[v] = cv;
+                    FillTransitionSquare(t, origin, u, v);
+                }
+            }
+        }
+
+        t.job->rawVertices.resize(vertexCount * 6);
+        t.job->rawIndices.resize(indexCount + t.transitionIndices.size());
+        std::copy(t.transitionIndices.begin(), t.transitionIndices.end(), t.job->rawIndices.begin() + indexCount);
+    }
+
+    // MARCHING SQUARES ON ONE FACE SQUARE, CORNERS IN ORDER AROUND IT - WRITES ITS 0 TO 2 SEGMENTS AND RETURNS HOW MANY
+    // A SADDLE PAIRS ITS CROSSINGS AROUND EACH CORNER ABOVE THE THRESHOLD, AS EVERY TriTable CASE DOES ON ITS FACES, SO THE
+    // SEGMENTS ARE THE ONES THE CELLS ON EITHER SIDE OF THE SQUARE MESH UP TO
+    // WITH middles A COARSE SQUARE'S CROSSINGS GET THE VERTEX OF THE FINE HALF THEY'RE ON
+    int SquareSegments(const MeshTask& t, const int* square[4], const int* middles[4], unsigned int segments[][2]) const
+    {
+        bool above[4];
+        for (int c=0; c<4; ++c) above[c] = t.Density(square[c]) > densityThreshold;
+
+        unsigned int crossing[4] = { 0, 0, 0, 0 };
+        int crossed[4];
+        int crossings = 0;
+        for (int e=0; e<4; ++e)
+        {
+            const int* c0 = square[e];
+            const int* c1 = square[(e + 1) % 4];
+            if (above[e] == above[(e + 1) % 4]) continue;
+
+            crossing[e] = t.EdgeVertex(c0, c1);
+            if (middles)
+            {
+                const int* m = middles[e];
+                crossing[e] = above[e] != (t.Density(m) > densityThreshold) ? t.EdgeVertex(c0, m) : t.EdgeVertex(m, c1);
+            }
+            crossed[crossings++] = e;
+        }
+
+        if (crossings == 2)
+        {
+            segments[0][0] = crossing[crossed[0]];
+            segments[0][1] = crossing[crossed[1]];
+            return 1;
+        }
+        if (crossings != 4) return 0;
+
+        // SIDES c - 1 AND c MEET AT CORNER c
+        int count = 0;
+        for (int c=0; c<4; ++c)
+        {
+            if (!above[c]) continue;
+            segments[count][0] = crossing[(c + 3) % 4];
+            segments[count][1] = crossing[c];
+            count += 1;
+        }
+        return count;
+    }
+
+    // THE COARSE NEIGHBOUR'S SEGMENTS ACROSS ONE COARSE FACE SQUARE AND THIS CHUNK'S FINE ONES MEET AT THE SAME CROSSINGS,
+    // SO TOGETHER THEY FORM CLOSED LOOPS AROUND THE GAPS BETWEEN THE TWO MESHES - EACH LOOP IS FILLED WITH A DOUBLE SIDED FAN
+    void FillTransitionSquare(MeshTask& t, const int origin[3], int u, int v) const
+    {
+        int samples[9][3];
+        for (int j=0; j<3; ++j) {
+            for (int i=0; i<3; ++i) {
+                for (int a=0; a<3; ++a) samples[i + j * 3][a] = origin[a];
+                samples[i + j * 3][u] += i;
+                samples[i + j * 3][v] += j;
+            }
+        }
+
+        // AT MOST 2 COARSE SEGMENTS AND 2 IN EACH FINE SQUARE
+        unsigned int segments[10][2];
+        const int* coarse[4] = { samples[0], samples[2], samples[8], samples[6] };
+        const int* middles[4] = { samples[1], samples[5], samples[7], samples[3] };
+        int coarseCount = SquareSegments(t, coarse, middles, segments);
+        if (coarseCount == 0) return;
+
+        int count = coarseCount;
+        for (int s=0; s<4; ++s)
+        {
+            int i = s & 1;
+            int j = s >> 1;
+            const int* fine[4] = { samples[i + j * 3], samples[i + 1 + j * 3], samples[i + 1 + (j + 1) * 3], samples[i + (j + 1) * 3] };
+            count += SquareSegments(t, fine, nullptr, segments + count);
+        }
+
+        // EVERY CROSSING ENDS ONE SEGMENT OF EACH SIDE - WALK EACH LOOP FROM A COARSE SEGMENT
+        bool used[10] = {};
+        unsigned int loop[10];
+        for (int first=0; first<coarseCount; ++first)
+        {
+            if (used[first]) continue;
+            used[first] = true;
+            int length = 1;
+            loop[0] = segments[first][0];
+            unsigned int end = segments[first][1];
+            while (end != loop[0] && length < count)
+            {
+                int next = -1;
+                for (int s=0; s<count && next < 0; ++s) {
+                    if (!used[s] && (segments[s][0] == end || segments[s][1] == end)) next = s;
+                }
+                if (next < 0) break;
+                used[next] = true;
+                loop[length++] = end;
+                end = segments[next][0] == end ? segments[next][1] : segments[next][0];
+            }
+            if (end != loop[0]) continue;
+
+            for (int i=1; i+1<length; ++i) {
+                t.transitionIndices.insert(t.transitionIndices.end(), { loop[0], loop[i], loop[i + 1], loop[0], loop[i + 1], loop[i] });
+            }
+        }
+    }
+
+    // CENTRAL DIFFERENCES, ONE SIDED ON THE CHUNK FACES
+    static glm::vec3 DensityGradient(const MeshTask& t, const int l[3])
+    {
+        glm::vec3 gradient;
+        for (int axis=0; axis<3; ++axis)
+        {
+            int lo[3] = { l[0], l[1], l[2] };
+            int hi[3] = { l[0], l[1], l[2] };
+            if (l[axis] > 0) lo[axis] -= 1;
+            if (l[axis] < t.cells[axis]) hi[axis] += 1;
+            gradient[axis] = (t.Density(hi) - t.Density(lo)) / static_cast<float>((hi[axis] - lo[axis]) * t.stride);
+        }
+        return gradient;
+    }
+
+    // STEP 4 - THE SLAB'S VERTICES AND TRIANGLES, WRITTEN WHERE THE PREFIX SUM PUT THEM
+    void EmitSlab(MeshTask& t, int s)
+    {
+        int z0, z1;
+        t.CornerLayers(s, z0, z1);
+        float* vertices = t.job->rawVertices.data();
+        unsigned int* indices = t.job->rawIndices.data();
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<=t.cells[1]; ++y)
+            {
+                const CornerRow& row = t.Row(y, z);
+                float* vertex = vertices + row.firstVertex * 6;
+                for (uint64_t corners = row.crossed[0] | row.crossed[1] | row.crossed[2]; corners != 0; corners &= corners - 1)
+                {
+                    int l[3] = { std::countr_zero(corners), y, z };
+                    for (int axis=0; axis<3; ++axis) {
+                        if (row.crossed[axis] >> l[0] & 1) vertex = WriteVertex(t, l, axis, vertex);
+                    }
+                }
+
+                if (row.cells == 0) continue;
+                const CornerRow& front = t.Row(y, z + 1);
+                const CornerRow& up = t.Row(y + 1, z);
+                const CornerRow& upFront = t.Row(y + 1, z + 1);
+                unsigned int* index = indices + row.firstIndex;
+                for (uint64_t cells = row.cells; cells != 0; cells &= cells - 1)
+                {
+                    int x = std::countr_zero(cells);
+                    int cubeIndex = CubeIndex(row.above, front.above, up.above, upFront.above, x);
+                    for (int i=0; TriTable[cubeIndex][i] != -1; ++i)
+                    {
+                        int edge = TriTable[cubeIndex][i];
+                        const int* a = cornerOffsets[cornerIndexAFromEdge[edge]];
+                        const int* b = cornerOffsets[cornerIndexBFromEdge[edge]];
+                        int ca[3] = { x + a[0], y + a[1], z + a[2] };
+                        int cb[3] = { x + b[0], y + b[1], z + b[2] };
+                        *index++ = t.EdgeVertex(ca, cb);
+                    }
+                }
+            }
+        }
+    }
+
+    // THE VERTEX ON THE EDGE FROM LOD CORNER l ALONG axis - RETURNS WHERE THE NEXT ONE GOES
+    float* WriteVertex(const MeshTask& t, const int l[3], int axis, float* out) const
+    {
+        int m[3] = { l[0], l[1], l[2] };
+        m[axis] += 1;
+        float d0 = t.Density(l);
+        float d1 = t.Density(m);
+        float along = (densityThreshold - d0) / (d1 - d0);
+        glm::vec3 normal = glm::mix(DensityGradient(t, l), DensityGradient(t, m), along);
+
+        // ALONG THE GRADIENT LIKE THE SHADER - A FLAT GRADIENT FALLS BACK TO THE EDGE DIRECTION
+        if (glm::dot(normal, normal) < 1e-12f) {
+            normal = glm::vec3(0.0f);
+            normal[axis] = d1 > d0 ? 1.0f : -1.0f;
+        }
+        normal = glm::normalize(normal);
+
+        for (int a=0; a<3; ++a) out[a] = static_cast<float>(l[a] * t.stride) + (a == axis ? along * t.stride : 0.0f);
+        out[3] = normal.x;
+        out[4] = normal.y;
+        out[5] = normal.z;
+        return out + 6;
+    }
+
+    // HANDS THE JOB BACK - A CANCELLED JOB'S OUTPUT IS NEVER READ
+    void Finish(MeshTask& t)
+    {
+        completedJobs.Push(t.job);
+        *t.batch -= 1;
+    }
+};
+
+#endif
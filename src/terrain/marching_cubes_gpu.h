@@ -5,11 +5,14 @@
 #include "../model.h"
 #include "../shader.h"
 #include "../error.h"
+#include "chunk_config.h"
+#include "chunk_job.h"
 #include "tables.h"
-#include "vertex_hashmap.h"
-#include "direct_addressor.h"
+#include "density_graph.h"
 #include <vector>
-#include <omp.h>
+#include <memory>
+#include <atomic>
+#include <cstring>
 #include <GL/glew.h>
 #include <iostream>
 #include <functional>
@@ -32,29 +35,18 @@ the GPU perlin noise system needs to have octaves and a surface
 i could shave off 2 - 3 ms if i improve the vertex hash speed
 */
 
-struct Chunk 
-{
-    int x;
-    int y;
-    int z;
-    bool checked = false;
-    bool regenerate = false;
-    std::vector<float> densities;
-    ~Chunk() {
-        densities.clear();
-    }
-};
-
 class TerrainGPU {
 public:
 
-	int width = 12;
-	int height = 12;
+	static constexpr int width = ChunkConfig::width;
+	static constexpr int height = ChunkConfig::height;
 
-	TerrainGPU()
+	TerrainGPU(const TerrainShape& shape = DefaultTerrainShape())
 	{
-        // LOAD COMPUTESHADER FROM FILE
-        std::string compShaderSource = LoadShader("./shaders/marching_cubes.compute");
+        // LOAD COMPUTESHADER FROM FILE - THE WORLD'S DENSITY GRAPH IS COMPILED TO GLSL AND APPENDED
+        std::string defines = ChunkConfig::ShaderDefines() + "#define DENSITY_GRAPH\n";
+        std::string compShaderSource = InjectDefines(LoadShader("./shaders/marching_cubes.compute"), defines);
+        compShaderSource += "\n" + shape.density.Optimize().EmitGLSL("GraphDensity");
         computeShaderProgram = CreateComputeShader(compShaderSource);
 
         // LOAD TRI TABLE
@@ -66,184 +58,239 @@ public:
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, triTableMemory);
         glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * 4096, TriTableValues.data(), GL_STATIC_READ); 
         glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, triTableMemory);
+
+        // PERMUTATION TABLE FOR THE IMPROVED PERLIN NOISE BACKEND
+        glGenBuffers(1, &permutationMemory);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, permutationMemory);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * Density::permutationSize, Density::PermutationTable(), GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 8, permutationMemory);
 	}
 
     ~TerrainGPU()
     {
-        // FREE TRITABLE GPU MEMORY
+        // FREE IN FLIGHT BATCHES
+        for (MeshBatch& batch : batches) FreeBatch(batch);
+
+        // FREE TRITABLE AND PERMUTATION TABLE GPU MEMORY
         glDeleteBuffers(1, &triTableMemory);
+        glDeleteBuffers(1, &permutationMemory);
     }
 
-    void GenerateMeshes(std::vector<Chunk*>& chunks, std::vector<Model*>& modelPtrs)
+    // UPLOADS THE CHUNK EDITS AND QUEUES THE COMPUTE SHADER - DOES NOT WAIT FOR THE GPU
+    void Dispatch(std::vector<std::shared_ptr<ChunkJob>>& jobs)
     {
+        if (jobs.empty()) return;
+
         glUseProgram(computeShaderProgram);
 
-        std::vector<unsigned int> Indices;
-        std::vector<float> Vertices((width + 1) * (width + 1) * (height + 1) * 48 * chunks.size(), -1.0f);
-        std::vector<float> DensityCache((width + 1) * (width + 1) * (height + 1) * chunks.size());
-        std::vector<float> densities;
+        std::vector<unsigned int> counters(2 * jobs.size(), 0);
+        std::vector<float> DensityCache(ChunkConfig::cornerCount * jobs.size());
+        std::vector<float> editValues;
         std::vector<int> offsets;
-        std::vector<int> editBooleans; 
+        std::vector<int> editBricks; 
+        std::vector<float> surfaceHeights;
+        std::vector<int> activeBlocks;
 
-        for (int i=0; i<chunks.size(); ++i)
+        for (int i=0; i<jobs.size(); ++i)
         {
-            offsets.push_back(chunks[i]->x);
-            offsets.push_back(chunks[i]->y);
-            offsets.push_back(chunks[i]->z);
-            editBooleans.push_back(chunks[i]->densities.size()>0);
-
-            for (int j=0; j<chunks[i]->densities.size(); ++j) {
-                densities.push_back(chunks[i]->densities[j]);
-            }
+            offsets.push_back(jobs[i]->x);
+            offsets.push_back(jobs[i]->y);
+            offsets.push_back(jobs[i]->z);
+            offsets.push_back(1 << jobs[i]->lod);
+            offsets.push_back(jobs[i]->transitionMask);
+
+            // BRICK HEADER: VALUE OFFSET (-1 WHEN UNEDITED), BRICK MIN CORNER, BRICK SIZE
+            const EditBrick* brick = jobs[i]->edits.get();
+            editBricks.push_back(brick ? static_cast<int>(editValues.size()) : -1);
+            editBricks.push_back(brick ? brick->minX : 0);
+            editBricks.push_back(brick ? brick->minY : 0);
+            editBricks.push_back(brick ? brick->minZ : 0);
+            editBricks.push_back(brick ? brick->sizeX : 0);
+            editBricks.push_back(brick ? brick->sizeY : 0);
+            editBricks.push_back(brick ? brick->sizeZ : 0);
+            if (brick) editValues.insert(editValues.end(), brick->values.begin(), brick->values.end());
+
+            const float* heights = jobs[i]->surface->Values();
+            surfaceHeights.insert(surfaceHeights.end(), heights, heights + ChunkConfig::cornersX * ChunkConfig::cornersX);
+
+            // UNCLASSIFIED JOBS (EDITS, LOD CHANGES) MESH EVERY BLOCK
+            if (jobs[i]->activeBlocks.empty()) activeBlocks.insert(activeBlocks.end(), ChunkConfig::blockCount, 1);
+            else activeBlocks.insert(activeBlocks.end(), jobs[i]->activeBlocks.begin(), jobs[i]->activeBlocks.end());
         }
 
+        // AN EMPTY SHADER STORAGE BUFFER CAN'T BE BOUND
+        if (editValues.empty()) editValues.push_back(0.0f);
+
         // shader uniforms
         BindUniformFloat1(computeShaderProgram, "densityThreshold", densityThreshold);
-        BindUniformInt1(computeShaderProgram, "chunkCount", chunks.size());
-
-        GLuint vertBuffer, densityBuffer, densityCache, offsetsBuffer, editFlags; 
-
-        // Bind buffer for vertices
-		glGenBuffers(1, &vertBuffer);
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertBuffer);
-		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * Vertices.size(), Vertices.data(), GL_DYNAMIC_DRAW);
-		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, vertBuffer);
-
-        // Bind buffer for densities
-        glGenBuffers(1, &densityBuffer);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, densityBuffer);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * densities.size(), densities.data(), GL_STATIC_READ);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, densityBuffer);
+        BindUniformInt1(computeShaderProgram, "chunkCount", jobs.size());
+
+        MeshBatch batch;
+        batch.jobs = jobs;
+
+        // Bind buffer for vertices - WRITTEN BY THE SHADER, NOTHING TO UPLOAD
+		glGenBuffers(1, &batch.vertBuffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.vertBuffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * vertexFloats * edgeCount * jobs.size(), nullptr, GL_DYNAMIC_READ);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, batch.vertBuffer);
+
+        // Bind buffer for the vertex and index counts of each chunk
+        glGenBuffers(1, &batch.counterBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.counterBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int) * counters.size(), counters.data(), GL_DYNAMIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 9, batch.counterBuffer);
+
+        // Bind buffer for the vertex on each crossed edge - ONLY READ ON THE GPU
+        glGenBuffers(1, &batch.edgeVertexBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.edgeVertexBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * edgeCount * jobs.size(), nullptr, GL_DYNAMIC_COPY);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 10, batch.edgeVertexBuffer);
+
+        // Bind buffer for indices
+        glGenBuffers(1, &batch.indexBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.indexBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int) * IndexCapacity() * jobs.size(), nullptr, GL_DYNAMIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 11, batch.indexBuffer);
+
+        // Bind buffer for edit densities - ONLY EDITED CHUNKS CONTRIBUTE
+        glGenBuffers(1, &batch.densityBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.densityBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * editValues.size(), editValues.data(), GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, batch.densityBuffer);
 
         // Bind buffer for density cache
-        glGenBuffers(1, &densityCache);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, densityCache);
+        glGenBuffers(1, &batch.densityCache);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.densityCache);
         glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * DensityCache.size(), DensityCache.data(), GL_DYNAMIC_DRAW);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, densityCache);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, batch.densityCache);
 
         // Bind buffer for chunk offsets
-        glGenBuffers(1, &offsetsBuffer);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, offsetsBuffer);
+        glGenBuffers(1, &batch.offsetsBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.offsetsBuffer);
         glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * offsets.size(), offsets.data(), GL_STATIC_READ);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, offsetsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, batch.offsetsBuffer);
+
+        // Bind buffer for edit brick headers
+        glGenBuffers(1, &batch.editBricks);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.editBricks);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * editBricks.size(), editBricks.data(), GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, batch.editBricks);
 
-        // Bind buffer for edit flags
-        glGenBuffers(1, &editFlags);
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, editFlags);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * editBooleans.size(), editBooleans.data(), GL_STATIC_READ);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, editFlags);
+        // Bind buffer for the surface heights of each chunk's column
+        glGenBuffers(1, &batch.surfaceHeights);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.surfaceHeights);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * surfaceHeights.size(), surfaceHeights.data(), GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, batch.surfaceHeights);
 
+        // Bind buffer for the cell blocks the classifier couldn't rule out
+        glGenBuffers(1, &batch.activeBlocks);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.activeBlocks);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(int) * activeBlocks.size(), activeBlocks.data(), GL_STATIC_READ);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 7, batch.activeBlocks);
 
-        // Compute
+
+        // Compute - VERTICES ON EVERY CORNER'S EDGES, THEN TRIANGLES INDEXING THEM
+        // FENCE INSTEAD OF glFinish SO THE MAIN THREAD KEEPS RENDERING
         glUseProgram(computeShaderProgram);
+        BindUniformInt1(computeShaderProgram, "meshPass", 0);
+        glDispatchCompute(width + 1, height + 1, width + 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+        BindUniformInt1(computeShaderProgram, "meshPass", 1);
         glDispatchCompute(width, height, width);
         glMemoryBarrier(GL_ALL_BARRIER_BITS);
-        glFinish();
-
-        // Copy vertex data from GPU to CPU
-        int size = (width+1)*(width+1)*(height+1) * 48;
-        std::vector<std::vector<float>> chunksVertices(chunks.size(), std::vector<float>(size));
-		glBindBuffer(GL_SHADER_STORAGE_BUFFER, vertBuffer); 
-		GLfloat* verticesDataPtr = nullptr;
-		verticesDataPtr = (GLfloat*)glMapBuffer(GL_SHADER_STORAGE_BUFFER, GL_READ_ONLY);
-		if (verticesDataPtr) {
-            for (int i=0; i<chunks.size(); ++i) {
-                int index = i * size;
-                std::memcpy(chunksVertices[i].data(), verticesDataPtr + index, size * sizeof(float));
-            }
-			glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
-		}
+        batch.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
 
-        // Free GPU memory
-        glDeleteBuffers(1, &vertBuffer);
-        glDeleteBuffers(1, &densityBuffer);
-        glDeleteBuffers(1, &densityCache);
-        glDeleteBuffers(1, &offsetsBuffer);
-        glDeleteBuffers(1, &editFlags);
+        batches.push_back(batch);
+    }
 
+    // COLLECTS THE RAW MESHES OF EVERY BATCH THE GPU HAS FINISHED - NEVER BLOCKS
+    void Poll(std::vector<std::shared_ptr<ChunkJob>>& finishedJobs)
+    {
+        for (int b=0; b<batches.size(); ++b)
+        {
+            MeshBatch& batch = batches[b];
+            GLenum status = glClientWaitSync(batch.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) continue;
+
+            // Copy mesh data from GPU to CPU - ONLY THE PREFIX EACH CHUNK'S COUNTERS REACHED, SKIPPING JOBS CANCELLED WHILE ON THE GPU
+            bool anyLive = std::any_of(batch.jobs.begin(), batch.jobs.end(), 
+                [](const std::shared_ptr<ChunkJob>& job) { return !job->cancelled; });
+            if (anyLive)
+            {
+                std::vector<unsigned int> counters(2 * batch.jobs.size());
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.counterBuffer);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(unsigned int) * counters.size(), counters.data());
 
-        // CPU OPERATIONS - CLEANING RAW VERTEX DATA 
-        float vertOffsetX = width * -0.5f + 0.5f;
-		float vertOffsetY = height * -0.5f + 0.5f;
-		float vertOffsetZ = width * -0.5f + 0.5f;
+                for (int i=0; i<batch.jobs.size(); ++i) {
+                    ChunkJob& job = *batch.jobs[i];
+                    if (job.cancelled) continue;
 
-        // FOR EACH CHUNK
-        #pragma omp parallel for
-        for (int c=0; c<chunks.size(); ++c)
-        {
-            Model& model = *modelPtrs[c];
-            std::vector<float>& vertices = chunksVertices[c];
-            VertexHasher vertexHasher;
+                    job.rawVertices.resize(counters[i * 2] * vertexFloats);
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.vertBuffer);
+                    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(float) * vertexFloats * edgeCount * i,
+                                       sizeof(float) * job.rawVertices.size(), job.rawVertices.data());
 
-            for (int i=0; i<vertices.size(); i+=12)
-            {
-                if (vertices[i] != -1.0f)
-                {
-                    // vertex 1
-                    if (vertexHasher.GetVertexIndex(vertices[i], vertices[i+1], vertices[i+2]) == -1)
-                    {
-                        vertexHasher.SetVertexIndex(vertices[i], vertices[i+1], vertices[i+2], model.VertexCount());
-                        model.indices.push_back(model.VertexCount());
-                        model.vertices.push_back(vertices[i] + vertOffsetX);
-                        model.vertices.push_back(vertices[i+1] + vertOffsetY);
-                        model.vertices.push_back(vertices[i+2] + vertOffsetZ);
-                        model.vertices.push_back(vertices[i+9]);
-                        model.vertices.push_back(vertices[i+10]);
-                        model.vertices.push_back(vertices[i+11]);
-                    }
-                    else
-                    {
-                        model.indices.push_back(vertexHasher.GetVertexIndex(vertices[i], vertices[i+1], vertices[i+2]));
-                    }
-
-                    // vertex 2
-                    if (vertexHasher.GetVertexIndex(vertices[i+3], vertices[i+4], vertices[i+5]) == -1)
-                    {
-                        vertexHasher.SetVertexIndex(vertices[i+3], vertices[i+4], vertices[i+5], model.VertexCount());
-                        model.indices.push_back(model.VertexCount());
-                        model.vertices.push_back(vertices[i+3] + vertOffsetX);
-                        model.vertices.push_back(vertices[i+4] + vertOffsetY);
-                        model.vertices.push_back(vertices[i+5] + vertOffsetZ);
-                        model.vertices.push_back(vertices[i+9]);
-                        model.vertices.push_back(vertices[i+10]);
-                        model.vertices.push_back(vertices[i+11]);
-                    }
-                    else
-                    {
-                        model.indices.push_back(vertexHasher.GetVertexIndex(vertices[i+3], vertices[i+4], vertices[i+5]));
-                    }
-
-                    // vertex 3
-                    if (vertexHasher.GetVertexIndex(vertices[i+6], vertices[i+7], vertices[i+8]) == -1)
-                    {
-                        vertexHasher.SetVertexIndex(vertices[i+6], vertices[i+7], vertices[i+8], model.VertexCount());
-                        model.indices.push_back(model.VertexCount());
-                        model.vertices.push_back(vertices[i+6] + vertOffsetX);
-                        model.vertices.push_back(vertices[i+7] + vertOffsetY);
-                        model.vertices.push_back(vertices[i+8] + vertOffsetZ);
-                        model.vertices.push_back(vertices[i+9]);
-                        model.vertices.push_back(vertices[i+10]);
-                        model.vertices.push_back(vertices[i+11]);
-                    }
-                    else
-                    {
-                        model.indices.push_back(vertexHasher.GetVertexIndex(vertices[i+6], vertices[i+7], vertices[i+8]));
-                    }
+                    job.rawIndices.resize(counters[i * 2 + 1]);
+                    glBindBuffer(GL_SHADER_STORAGE_BUFFER, batch.indexBuffer);
+                    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, sizeof(unsigned int) * IndexCapacity() * i,
+                                       sizeof(unsigned int) * job.rawIndices.size(), job.rawIndices.data());
+
+                    finishedJobs.push_back(batch.jobs[i]);
                 }
             }
 
-            model.position = {chunks[c]->x, chunks[c]->y, chunks[c]->z};
-            model.boundingBox.min = glm::vec3(chunks[c]->x + width/2, chunks[c]->y + height/2, chunks[c]->z + width/2);
-            model.boundingBox.max = glm::vec3(chunks[c]->x - width/2, chunks[c]->y - height/2, chunks[c]->z - width/2);
-            model.boundingBox.isFilled = true;
+            // Free GPU memory
+            FreeBatch(batch);
+            batches.erase(batches.begin() + b);
+            --b;
         }
     }
 
+    int BatchesInFlight() const { return static_cast<int>(batches.size()); }
+
+    float DensityThreshold() const { return densityThreshold; }
+
+
 private:
     float densityThreshold = 0.7f;
+
+    // MUST MATCH edgeCount, vertexFloats AND indexCapacity IN THE COMPUTE SHADER
+    // AT MOST ONE VERTEX PER LATTICE EDGE, 5 TRIANGLES PER CELL AND 12 PER TRANSITION SQUARE
+    static constexpr int edgeCount = ChunkConfig::cornerCount * 3;
+    static constexpr int vertexFloats = 6;
+    static constexpr int IndexCapacity()
+    {
+        constexpr int squaresPerRow = std::max(width, height) / 2;
+        return (width * height * width * 5 + 6 * squaresPerRow * squaresPerRow * 12) * 3;
+    }
     unsigned int computeShaderProgram;
 	std::vector<int> TriTableValues;
     GLuint triTableMemory;
+    GLuint permutationMemory;
+
+    struct MeshBatch
+    {
+        std::vector<std::shared_ptr<ChunkJob>> jobs;
+        GLuint vertBuffer, counterBuffer, edgeVertexBuffer, indexBuffer, densityBuffer, densityCache, offsetsBuffer, editBricks, surfaceHeights, activeBlocks;
+        GLsync fence;
+    };
+    std::vector<MeshBatch> batches;
+
+    void FreeBatch(MeshBatch& batch)
+    {
+        glDeleteSync(batch.fence);
+        glDeleteBuffers(1, &batch.vertBuffer);
+        glDeleteBuffers(1, &batch.counterBuffer);
+        glDeleteBuffers(1, &batch.edgeVertexBuffer);
+        glDeleteBuffers(1, &batch.indexBuffer);
+        glDeleteBuffers(1, &batch.densityBuffer);
+        glDeleteBuffers(1, &batch.densityCache);
+        glDeleteBuffers(1, &batch.offsetsBuffer);
+        glDeleteBuffers(1, &batch.editBricks);
+        glDeleteBuffers(1, &batch.surfaceHeights);
+        glDeleteBuffers(1, &batch.activeBlocks);
+    }
 
 	std::vector<int> LoadTriTableValues()
     {
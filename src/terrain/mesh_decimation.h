@@ -0,0 +1,340 @@
+#ifndef MESH_DECIMATION_H
+#define MESH_DECIMATION_H
+
+#include "../vendor/glm/glm.hpp"
+#include <vector>
+#include <queue>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+
+/*
+Quadric error edge collapse (Garland and Heckbert) for chunk meshes, run on the worker pool after meshing.
+Every vertex carries the sum of the planes of its triangles; collapsing u onto its neighbour v costs the summed
+squared distances of v's position to both vertices' planes, and collapses run cheapest first until the next one
+would cost more than the error budget squared. Collapses are half edge - v stays where it is with its normal - so no
+new vertex is ever made up, and one is refused when it would flip a triangle or pinch the surface.
+The quadric cost only orders the collapses - it doesn't bound how far the surface moves. The budget is enforced on
+the removed vertices themselves: each one is carried by a corner of the nearest triangle left, and a collapse is
+refused when any vertex carried around it would end up more than the budget from the triangles around it after the
+collapse. Only triangles with u in them change, and their corners are u and its neighbours, so those are the only
+carriers to check - no original vertex ends up further than the budget from the decimated mesh.
+Vertices a neighbouring chunk's mesh shares never move: those on or outside the lock box (the chunk faces, or the
+apron and last cell layer of a dual mesh) and those on open or non-manifold edges.
+*/
+
+namespace MeshDecimation
+{
+    // SYMMETRIC 4 X 4 MATRIX OF A SUM OF PLANES, UPPER TRIANGLE
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+        void AddPlane(const glm::dvec3& n, double d)
+        {
+            a2 += n.x * n.x; ab += n.x * n.y; ac += n.x * n.z; ad += n.x * d;
+            b2 += n.y * n.y; bc += n.y * n.z; bd += n.y * d;
+            c2 += n.z * n.z; cd += n.z * d;
+            d2 += d * d;
+        }
+
+        void Add(const Quadric& q)
+        {
+            a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad; b2 += q.b2;
+            bc += q.bc; bd += q.bd; c2 += q.c2; cd += q.cd; d2 += q.d2;
+        }
+
+        // SUM OF SQUARED DISTANCES FROM p TO THE PLANES
+        double Error(const glm::dvec3& p) const
+        {
+            return a2 * p.x * p.x + 2 * ab * p.x * p.y + 2 * ac * p.x * p.z + 2 * ad * p.x
+                 + b2 * p.y * p.y + 2 * bc * p.y * p.z + 2 * bd * p.y
+                 + c2 * p.z * p.z + 2 * cd * p.z + d2;
+        }
+    };
+
+    // u ONTO v - STALE ONCE EITHER VERTEX HAS CHANGED SINCE IT WAS QUEUED
+    struct Collapse
+    {
+        double cost;
+        int u, v;
+        int versionU, versionV;
+        bool operator<(const Collapse& other) const { return cost > other.cost; } // CHEAPEST ON TOP
+    };
+
+    struct Mesh
+    {
+        const float* vertices;                // POSITION, NORMAL
+        std::vector<unsigned int> triangles;  // 3 PER TRIANGLE, A REMOVED ONE HAS ALL 3 SET TO removed
+        std::vector<std::vector<int>> around; // TRIANGLES OF EACH VERTEX - MAY HOLD REMOVED ONES
+        std::vector<Quadric> quadrics;
+        std::vector<int> version;
+        std::vector<char> locked;
+        std::vector<char> gone;
+        std::vector<std::vector<int>> carried; // REMOVED VERTICES WHOSE NEAREST TRIANGLE HAS THIS VERTEX AS A CORNER
+        std::vector<int> mark;                 // PER TRIANGLE, FOR COLLECTING EACH ONCE
+        int markStamp = 0;
+        static constexpr unsigned int removed = 0xFFFFFFFFu;
+
+        glm::dvec3 Position(int v) const { return glm::dvec3(vertices[v * 6], vertices[v * 6 + 1], vertices[v * 6 + 2]); }
+        bool Alive(int t) const { return triangles[t * 3] != removed; }
+        bool Has(int t, int v) const
+        {
+            return triangles[t * 3] == static_cast<unsigned int>(v) || triangles[t * 3 + 1] == static_cast<unsigned int>(v) || triangles[t * 3 + 2] == static_cast<unsigned int>(v);
+        }
+
+        // FACE NORMAL, UNNORMALIZED, WITH u MOVED TO p
+        glm::dvec3 Normal(int t, int u, const glm::dvec3& p) const
+        {
+            glm::dvec3 c[3];
+            for (int i=0; i<3; ++i) c[i] = triangles[t * 3 + i] == static_cast<unsigned int>(u) ? p : Position(triangles[t * 3 + i]);
+            return glm::cross(c[1] - c[0], c[2] - c[0]);
+        }
+
+        void Neighbours(int v, std::vector<int>& out) const
+        {
+            out.clear();
+            for (int t : around[v])
+            {
+                if (!Alive(t)) continue;
+                for (int i=0; i<3; ++i) {
+                    int w = static_cast<int>(triangles[t * 3 + i]);
+                    if (w != v && std::find(out.begin(), out.end(), w) == out.end()) out.push_back(w);
+                }
+            }
+        }
+    };
+
+    // TRUE WHEN u CAN MOVE ONTO v WITHOUT FLIPPING OR FLATTENING A TRIANGLE, OR JOINING TWO SHEETS AT ONE EDGE
+    inline bool CanCollapse(const Mesh& mesh, int u, int v, std::vector<int>& nu, std::vector<int>& nv)
+    {
+        // LINK CONDITION - THE ONLY VERTICES BOTH ENDS SEE ARE THE THIRD CORNERS OF THE TRIANGLES ON THE EDGE
+        int shared = 0;
+        for (int t : mesh.around[u]) shared += mesh.Alive(t) && mesh.Has(t, v);
+        mesh.Neighbours(u, nu);
+        mesh.Neighbours(v, nv);
+        int common = 0;
+        for (int w : nu) common += std::find(nv.begin(), nv.end(), w) != nv.end();
+        if (shared == 0 || common != shared) return false;
+
+        glm::dvec3 p = mesh.Position(v);
+        for (int t : mesh.around[u])
+        {
+            if (!mesh.Alive(t) || mesh.Has(t, v)) continue;
+            glm::dvec3 before = mesh.Normal(t, u, mesh.Position(u));
+            glm::dvec3 after = mesh.Normal(t, u, p);
+            double lengths = glm::length(before) * glm::length(after);
+            if (lengths < 1e-12 || glm::dot(before, after) < 0.5 * lengths) return false;
+        }
+        return true;
+    }
+
+    // DISTANCE FROM p TO THE TRIANGLE abc
+    inline double PointTriangleDistance(const glm::dvec3& p, const glm::dvec3& a, const glm::dvec3& b, const glm::dvec3& c)
+    {
+        glm::dvec3 n = glm::cross(b - a, c - a);
+        double area = glm::dot(n, n);
+        if (area > 1e-24)
+        {
+            // INSIDE THE PRISM OVER THE TRIANGLE - THE PLANE IS CLOSEST
+            glm::dvec3 corners[3] = { a, b, c };
+            bool inside = true;
+            for (int i=0; i<3; ++i) {
+                if (glm::dot(glm::cross(corners[(i + 1) % 3] - corners[i], p - corners[i]), n) < 0.0) inside = false;
+            }
+            if (inside) return std::abs(glm::dot(p - a, n)) / std::sqrt(area);
+        }
+
+        // OTHERWISE AN EDGE IS
+        double closest = 1e30;
+        glm::dvec3 ends[3][2] = { { a, b }, { b, c }, { c, a } };
+        for (auto& edge : ends)
+        {
+            glm::dvec3 d = edge[1] - edge[0];
+            double t = glm::dot(d, d) > 0.0 ? std::clamp(glm::dot(p - edge[0], d) / glm::dot(d, d), 0.0, 1.0) : 0.0;
+            closest = std::min(closest, glm::length(p - (edge[0] + d * t)));
+        }
+        return closest;
+    }
+
+    // TRUE WHEN EVERY VERTEX CARRIED BY u OR ITS NEIGHBOURS nu (AND u ITSELF) STAYS WITHIN maxError OF THE TRIANGLES AROUND
+    // THEM ONCE u IS ON v - carriers GETS THE NEW CARRIER OF EACH, points THE VERTICES IN THE SAME ORDER
+    inline bool WithinBudget(Mesh& mesh, int u, int v, const std::vector<int>& nu, double maxError, std::vector<int>& points, std::vector<int>& carriers, std::vector<int>& patch)
+    {
+        points.assign(1, u);
+        points.insert(points.end(), mesh.carried[u].begin(), mesh.carried[u].end());
+        for (int w : nu) points.insert(points.end(), mesh.carried[w].begin(), mesh.carried[w].end());
+
+        // THE TRIANGLES AROUND u AND ITS NEIGHBOURS AS THEY WILL BE - THE TWO ON THE EDGE GO
+        mesh.markStamp += 1;
+        patch.clear();
+        auto Collect = [&](int vertex) {
+            for (int t : mesh.around[vertex])
+            {
+                if (!mesh.Alive(t) || mesh.mark[t] == mesh.markStamp) continue;
+                mesh.mark[t] = mesh.markStamp;
+                if (!(mesh.Has(t, u) && mesh.Has(t, v))) patch.push_back(t);
+            }
+        };
+        Collect(u);
+        for (int w : nu) Collect(w);
+
+        carriers.resize(points.size());
+        for (int i=0; i<points.size(); ++i)
+        {
+            glm::dvec3 p = mesh.Position(points[i]);
+            double nearest = 1e30;
+            for (int t : patch)
+            {
+                int corner[3];
+                for (int k=0; k<3; ++k) {
+                    corner[k] = static_cast<int>(mesh.triangles[t * 3 + k]);
+                    if (corner[k] == u) corner[k] = v;
+                }
+                double distance = PointTriangleDistance(p, mesh.Position(corner[0]), mesh.Position(corner[1]), mesh.Position(corner[2]));
+                if (distance < nearest) {
+                    nearest = distance;
+                    carriers[i] = corner[0];
+                }
+            }
+            if (nearest > maxError) return false;
+        }
+        return true;
+    }
+
+    inline void Queue(const Mesh& mesh, std::priority_queue<Collapse>& queue, int u, int v)
+    {
+        if (mesh.locked[u] || mesh.gone[u] || mesh.gone[v]) return;
+        Quadric q = mesh.quadrics[u];
+        q.Add(mesh.quadrics[v]);
+        queue.push({ std::max(0.0, q.Error(mesh.Position(v))), u, v, mesh.version[u], mesh.version[v] });
+    }
+
+    // DECIMATES THE INDEXED MESH IN PLACE - VERTICES ARE POSITION AND NORMAL, 6 FLOATS EACH
+    // VERTICES WITH A COORDINATE AT OR OUTSIDE [lockMin, lockMax] KEEP THEIR PLACE
+    // NO ORIGINAL VERTEX ENDS UP MORE THAN maxError (WORLD UNITS) FROM THE DECIMATED MESH
+    inline void Decimate(std::vector<float>& vertices, std::vector<unsigned int>& indices, float maxError, const glm::vec3& lockMin, const glm::vec3& lockMax)
+    {
+        int vertexCount = static_cast<int>(vertices.size() / 6);
+        int triangleCount = static_cast<int>(indices.size() / 3);
+        if (triangleCount == 0 || maxError <= 0.0f) return;
+
+        Mesh mesh;
+        mesh.vertices = vertices.data();
+        mesh.triangles = indices;
+        mesh.around.resize(vertexCount);
+        mesh.quadrics.resize(vertexCount);
+        mesh.version.assign(vertexCount, 0);
+        mesh.locked.assign(vertexCount, 0);
+        mesh.gone.assign(vertexCount, 0);
+        mesh.carried.resize(vertexCount);
+        mesh.mark.assign(triangleCount, 0);
+
+        // PLANES, AND HOW MANY TRIANGLES USE EACH EDGE
+        std::unordered_map<uint64_t, int> edgeUses;
+        edgeUses.reserve(indices.size());
+        auto EdgeKey = [](unsigned int a, unsigned int b) { return (static_cast<uint64_t>(std::min(a, b)) << 32) | std::max(a, b); };
+        for (int t=0; t<triangleCount; ++t)
+        {
+            for (int i=0; i<3; ++i)
+            {
+                mesh.around[indices[t * 3 + i]].push_back(t);
+                edgeUses[EdgeKey(indices[t * 3 + i], indices[t * 3 + (i + 1) % 3])] += 1;
+            }
+            glm::dvec3 n = mesh.Normal(t, -1, glm::dvec3(0.0));
+            double length = glm::length(n);
+            if (length < 1e-12) continue;
+            n /= length;
+            double d = -glm::dot(n, mesh.Position(indices[t * 3]));
+            for (int i=0; i<3; ++i) mesh.quadrics[indices[t * 3 + i]].AddPlane(n, d);
+        }
+
+        for (int v=0; v<vertexCount; ++v)
+        {
+            for (int a=0; a<3; ++a) {
+                if (vertices[v * 6 + a] <= lockMin[a] || vertices[v * 6 + a] >= lockMax[a]) mesh.locked[v] = 1;
+            }
+        }
+        for (const std::pair<const uint64_t, int>& edge : edgeUses)
+        {
+            if (edge.second == 2) continue;
+            mesh.locked[edge.first >> 32] = 1;
+            mesh.locked[edge.first & 0xFFFFFFFFu] = 1;
+        }
+
+        std::priority_queue<Collapse> queue;
+        for (const std::pair<const uint64_t, int>& edge : edgeUses)
+        {
+            int a = static_cast<int>(edge.first >> 32);
+            int b = static_cast<int>(edge.first & 0xFFFFFFFFu);
+            Queue(mesh, queue, a, b);
+            Queue(mesh, queue, b, a);
+        }
+
+        double maxCost = double(maxError) * maxError;
+        std::vector<int> nu, nv, points, carriers, patch;
+        while (!queue.empty())
+        {
+            Collapse c = queue.top();
+            queue.pop();
+            if (c.cost > maxCost) break;
+            if (mesh.gone[c.u] || mesh.gone[c.v] || c.versionU != mesh.version[c.u] || c.versionV != mesh.version[c.v]) continue;
+            if (!CanCollapse(mesh, c.u, c.v, nu, nv)) continue;
+            if (!WithinBudget(mesh, c.u, c.v, nu, maxError, points, carriers, patch)) continue;
+
+            // EVERY VERTEX CHECKED MOVES TO A CORNER OF ITS NEAREST TRIANGLE
+            mesh.carried[c.u].clear();
+            for (int w : nu) mesh.carried[w].clear();
+            for (int i=0; i<points.size(); ++i) mesh.carried[carriers[i]].push_back(points[i]);
+
+            // TRIANGLES ON THE EDGE GO, THE REST OF u'S MOVE TO v
+            for (int t : mesh.around[c.u])
+            {
+                if (!mesh.Alive(t)) continue;
+                if (mesh.Has(t, c.v))
+                {
+                    for (int i=0; i<3; ++i) mesh.triangles[t * 3 + i] = Mesh::removed;
+                    continue;
+                }
+                for (int i=0; i<3; ++i) {
+                    if (mesh.triangles[t * 3 + i] == static_cast<unsigned int>(c.u)) mesh.triangles[t * 3 + i] = c.v;
+                }
+                mesh.around[c.v].push_back(t);
+            }
+            mesh.around[c.u].clear();
+            mesh.gone[c.u] = 1;
+            mesh.quadrics[c.v].Add(mesh.quadrics[c.u]);
+            mesh.version[c.v] += 1;
+
+            // EVERY EDGE AT v HAS A NEW COST
+            mesh.Neighbours(c.v, nv);
+            for (int w : nv)
+            {
+                Queue(mesh, queue, c.v, w);
+                Queue(mesh, queue, w, c.v);
+            }
+        }
+
+        // COMPACT - VERTICES KEEP THEIR ORDER
+        std::vector<unsigned int> remap(vertexCount, Mesh::removed);
+        unsigned int kept = 0;
+        indices.clear();
+        for (int t=0; t<triangleCount; ++t)
+        {
+            if (!mesh.Alive(t)) continue;
+            for (int i=0; i<3; ++i) indices.push_back(mesh.triangles[t * 3 + i]);
+        }
+        for (unsigned int v : indices) remap[v] = 0;
+        for (int v=0; v<vertexCount; ++v)
+        {
+            if (remap[v] == Mesh::removed) continue;
+            remap[v] = kept;
+            std::copy(vertices.begin() + v * 6, vertices.begin() + v * 6 + 6, vertices.begin() + kept * 6);
+            kept += 1;
+        }
+        vertices.resize(kept * 6);
+        for (unsigned int& v : indices) v = remap[v];
+    }
+}
+
+#endif
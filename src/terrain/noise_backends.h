@@ -0,0 +1,197 @@
+#ifndef NOISE_BACKENDS_H
+#define NOISE_BACKENDS_H
+
+#include <cmath>
+#include <cstdint>
+#include "density.h"
+
+/*
+Alternatives to the sin / cos hashed gradients of Density::Perlin3D, for the 3D (cave) noise.
+Permutation is Ken Perlin's improved noise: a 256 entry permutation table picks one of 12 cube edge gradients and
+the weights use the quintic fade. OpenSimplex2 sums the kernels of the nearest points of two offset cubic
+lattices in a rotated frame, hashed with 32 bit primes (GLSL 4.3 has no 64 bit ints) onto the same 12 gradients.
+Neither needs a transcendental per lattice point. Both are scaled to the spread (standard deviation) of Perlin3D
+so either drops into the default terrain without retuning its weights. Every backend returns values in [0, 1],
+and the compute shader has a copy of each - the permutation table is uploaded to it from here.
+*/
+
+enum class NoiseBackend
+{
+    Hash,         // Density::Perlin3D
+    Permutation,  // IMPROVED PERLIN NOISE
+    OpenSimplex2
+};
+
+namespace Density
+{
+    inline const char* NoiseBackendName(NoiseBackend backend)
+    {
+        switch (backend)
+        {
+            case NoiseBackend::Permutation:  return "permutation";
+            case NoiseBackend::OpenSimplex2: return "opensimplex2";
+            default:                         return "hash";
+        }
+    }
+
+    // KEN PERLIN'S REFERENCE PERMUTATION, REPEATED SO LOOKUPS OF (p[i] + j) NEVER WRAP
+    const int permutationSize = 512;
+    inline const int* PermutationTable()
+    {
+        static const int base[256] = {
+            151,160,137,91,90,15,131,13,201,95,96,53,194,233,7,225,140,36,103,30,69,142,8,99,37,240,21,10,23,
+            190,6,148,247,120,234,75,0,26,197,62,94,252,219,203,117,35,11,32,57,177,33,88,237,149,56,87,174,20,
+            125,136,171,168,68,175,74,165,71,134,139,48,27,166,77,146,158,231,83,111,229,122,60,211,133,230,220,
+            105,92,41,55,46,245,40,244,102,143,54,65,25,63,161,1,216,80,73,209,76,132,187,208,89,18,169,200,196,
+            135,130,116,188,159,86,164,100,109,198,173,186,3,64,52,217,226,250,124,123,5,202,38,147,118,126,255,
+            82,85,212,207,206,59,227,47,16,58,17,182,189,28,42,223,183,170,213,119,248,152,2,44,154,163,70,221,
+            153,101,155,167,43,172,9,129,22,39,253,19,98,108,110,79,113,224,232,178,185,112,104,218,246,97,228,
+            251,34,242,193,238,210,144,12,191,179,162,241,81,51,145,235,249,14,239,107,49,192,214,31,181,199,
+            106,157,184,84,204,176,115,121,50,45,127,4,150,254,138,236,205,93,222,114,67,29,24,72,243,141,128,
+            195,78,66,215,61,156,180
+        };
+        struct Repeated
+        {
+            int values[permutationSize];
+            Repeated() { for (int i=0; i<permutationSize; ++i) values[i] = base[i & 255]; }
+        };
+        static const Repeated table;
+        return table.values;
+    }
+
+    // THE 12 CUBE EDGE DIRECTIONS PADDED TO 16 SO A 4 BIT HASH PICKS ONE - SAME ORDER AS THE REFERENCE grad()
+    const float edgeGradients[16][3] = {
+        { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 },
+        { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 },
+        { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 },
+        { 1, 1, 0 }, { 0, -1, 1 }, { -1, 1, 0 }, { 0, -1, -1 }
+    };
+
+    inline float EdgeGradientDot(int hash, float x, float y, float z)
+    {
+        const float* g = edgeGradients[hash & 15];
+        return g[0] * x + g[1] * y + g[2] * z;
+    }
+
+    // STANDARD DEVIATION OF Perlin3D OVER THAT OF EACH BACKEND, MEASURED OVER 2e7 RANDOM POINTS
+    const float permutationContrast = 0.5416f;
+    const float simplexContrast = 0.3387f;
+
+    inline float Fade(float t)
+    {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+
+    inline float Lerp(float a, float b, float t)
+    {
+        return a + (b - a) * t;
+    }
+
+    // IN [0, 1]
+    inline float ImprovedPerlin3D(float x, float y, float z)
+    {
+        const int* p = PermutationTable();
+        float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+        int X = static_cast<int>(fx) & 255;
+        int Y = static_cast<int>(fy) & 255;
+        int Z = static_cast<int>(fz) & 255;
+        x -= fx;
+        y -= fy;
+        z -= fz;
+        float u = Fade(x), v = Fade(y), w = Fade(z);
+
+        int A = p[X] + Y, AA = p[A] + Z, AB = p[A + 1] + Z;
+        int B = p[X + 1] + Y, BA = p[B] + Z, BB = p[B + 1] + Z;
+
+        float value = Lerp(Lerp(Lerp(EdgeGradientDot(p[AA], x, y, z),         EdgeGradientDot(p[BA], x - 1, y, z), u),
+                                Lerp(EdgeGradientDot(p[AB], x, y - 1, z),     EdgeGradientDot(p[BB], x - 1, y - 1, z), u), v),
+                           Lerp(Lerp(EdgeGradientDot(p[AA + 1], x, y, z - 1), EdgeGradientDot(p[BA + 1], x - 1, y, z - 1), u),
+                                Lerp(EdgeGradientDot(p[AB + 1], x, y - 1, z - 1), EdgeGradientDot(p[BB + 1], x - 1, y - 1, z - 1), u), v), w);
+        return (value * permutationContrast + 1.0f) / 2.0f;
+    }
+
+    const uint32_t simplexPrimeX = 501125321u;
+    const uint32_t simplexPrimeY = 1136930381u;
+    const uint32_t simplexPrimeZ = 1720413743u;
+    const float simplexScale = 32.69428253f; // MAXIMUM OF THE KERNEL SUM FOR LENGTH sqrt(2) GRADIENTS
+
+    inline float SimplexGradientDot(uint32_t seed, uint32_t xPrimed, uint32_t yPrimed, uint32_t zPrimed, float x, float y, float z)
+    {
+        uint32_t hash = (seed ^ xPrimed ^ yPrimed ^ zPrimed) * 0x27d4eb2du;
+        hash ^= hash >> 15;
+        return EdgeGradientDot(static_cast<int>(hash), x, y, z);
+    }
+
+    inline int SimplexRound(float x)
+    {
+        return x >= 0.0f ? static_cast<int>(x + 0.5f) : static_cast<int>(x - 0.5f);
+    }
+
+    // IN [0, 1]
+    inline float OpenSimplex3D(float x, float y, float z)
+    {
+        // ROTATE SO THE LATTICE'S MAIN DIAGONAL LINES UP WITH Y
+        float r = (x + y + z) * (2.0f / 3.0f);
+        x = r - x;
+        y = r - y;
+        z = r - z;
+
+        int i = SimplexRound(x), j = SimplexRound(y), k = SimplexRound(z);
+        float x0 = x - i, y0 = y - j, z0 = z - k;
+
+        // -1 WHERE THE OFFSET IS POSITIVE, 1 WHERE IT ISN'T
+        int xSign = static_cast<int>(-1.0f - x0) | 1, ySign = static_cast<int>(-1.0f - y0) | 1, zSign = static_cast<int>(-1.0f - z0) | 1;
+        float ax0 = xSign * -x0, ay0 = ySign * -y0, az0 = zSign * -z0;
+
+        uint32_t ip = static_cast<uint32_t>(i) * simplexPrimeX, jp = static_cast<uint32_t>(j) * simplexPrimeY, kp = static_cast<uint32_t>(k) * simplexPrimeZ;
+        uint32_t seed = 0;
+
+        float value = 0.0f;
+        float a = (0.6f - x0 * x0) - (y0 * y0 + z0 * z0);
+        for (int lattice=0; ; ++lattice)
+        {
+            // CLOSEST POINT
+            if (a > 0.0f) value += (a * a) * (a * a) * SimplexGradientDot(seed, ip, jp, kp, x0, y0, z0);
+
+            // SECOND CLOSEST POINT, ACROSS THE FACE WITH THE LARGEST OFFSET
+            float b = a + 1.0f;
+            uint32_t i1 = ip, j1 = jp, k1 = kp;
+            float x1 = x0, y1 = y0, z1 = z0;
+            if (ax0 >= ay0 && ax0 >= az0) { x1 += xSign; b -= xSign * 2 * x1; i1 -= xSign * simplexPrimeX; }
+            else if (ay0 > ax0 && ay0 >= az0) { y1 += ySign; b -= ySign * 2 * y1; j1 -= ySign * simplexPrimeY; }
+            else { z1 += zSign; b -= zSign * 2 * z1; k1 -= zSign * simplexPrimeZ; }
+            if (b > 0.0f) value += (b * b) * (b * b) * SimplexGradientDot(seed, i1, j1, k1, x1, y1, z1);
+
+            if (lattice == 1) break;
+
+            // MOVE TO THE SECOND LATTICE, OFFSET BY HALF A CELL ON EVERY AXIS
+            ax0 = 0.5f - ax0;
+            ay0 = 0.5f - ay0;
+            az0 = 0.5f - az0;
+            x0 = xSign * ax0;
+            y0 = ySign * ay0;
+            z0 = zSign * az0;
+            a += (0.75f - ax0) - (ay0 + az0);
+            ip += (xSign >> 1) & simplexPrimeX;
+            jp += (ySign >> 1) & simplexPrimeY;
+            kp += (zSign >> 1) & simplexPrimeZ;
+            xSign = -xSign;
+            ySign = -ySign;
+            zSign = -zSign;
+            seed = ~seed;
+        }
+        return (value * simplexScale * simplexContrast + 1.0f) / 2.0f;
+    }
+
+    inline float Noise3D(NoiseBackend backend, float x, float y, float z)
+    {
+        switch (backend)
+        {
+            case NoiseBackend::Permutation:  return ImprovedPerlin3D(x, y, z);
+            case NoiseBackend::OpenSimplex2: return OpenSimplex3D(x, y, z);
+            default:                         return Perlin3D(x, y, z);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,386 @@
+#ifndef REGION_FILE_H
+#define REGION_FILE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <memory>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include "edit_overlay.h"
+#include "chunk_coords.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/*
+Persistent terrain edits.
+Chunks are grouped into regions of regionSize^3 chunks, one file per region. A file starts with a fixed header
+and an offset table with one entry per chunk, followed by the edit payloads of the chunks that have been edited.
+Files are memory mapped for reading, so loading a chunk is a table lookup and a decode straight out of the
+mapped pages. Writes append the payload (or overwrite it in place when it still fits) and patch the table entry.
+
+Payload: brick box (6 x int32), then runs of [uint32 zeros][uint32 literals][float x literals] until the brick is full.
+Most of a brick is untouched corners around a spherical edit, so the zero runs do most of the compressing.
+*/
+
+namespace Region
+{
+    const int regionSize = 8;
+    const int chunksPerRegion = regionSize * regionSize * regionSize;
+    const uint32_t magic = 0x4752434D; // "MCRG"
+    const uint32_t version = 1;
+    const int maxEditApron = 1; // CORNER LAYERS BEFORE A CHUNK'S - FACES A BRICK CAN REACH, SEE TerrainSystem::editApron
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t chunkWidth;
+        int32_t chunkHeight;
+    };
+
+    struct TableEntry
+    {
+        uint32_t offset; // 0 = CHUNK HAS NO EDITS
+        uint32_t size;
+    };
+
+    const size_t tableOffset = sizeof(Header);
+    const size_t payloadOffset = tableOffset + chunksPerRegion * sizeof(TableEntry);
+
+    inline void Append(std::vector<unsigned char>& out, const void* data, size_t bytes)
+    {
+        const unsigned char* begin = static_cast<const unsigned char*>(data);
+        out.insert(out.end(), begin, begin + bytes);
+    }
+
+    inline std::vector<unsigned char> Encode(const EditBrick& brick)
+    {
+        std::vector<unsigned char> out;
+        int32_t box[6] = { brick.minX, brick.minY, brick.minZ, brick.sizeX, brick.sizeY, brick.sizeZ };
+        Append(out, box, sizeof(box));
+
+        size_t i = 0;
+        while (i < brick.values.size())
+        {
+            uint32_t zeros = 0;
+            while (i + zeros < brick.values.size() && brick.values[i + zeros] == 0.0f) zeros += 1;
+            i += zeros;
+
+            uint32_t literals = 0;
+            while (i + literals < brick.values.size() && brick.values[i + literals] != 0.0f) literals += 1;
+
+            Append(out, &zeros, sizeof(zeros));
+            Append(out, &literals, sizeof(literals));
+            Append(out, brick.values.data() + i, literals * sizeof(float));
+            i += literals;
+        }
+        return out;
+    }
+
+    // RETURNS NULL FOR A TRUNCATED OR CORRUPT PAYLOAD - THE BRICK MUST LIE IN THE CORNERS OF A CHUNK THE HEADER'S SIZE
+    // (PLUS THE APRON), SO A BAD ENTRY CAN'T ASK FOR MORE THAN ONE CHUNK'S WORTH OF MEMORY
+    inline std::shared_ptr<EditBrick> Decode(const unsigned char* data, size_t size, int chunkWidth, int chunkHeight)
+    {
+        int32_t box[6];
+        if (size < sizeof(box)) return nullptr;
+        std::memcpy(box, data, sizeof(box));
+        int corners[3] = { chunkWidth, chunkHeight, chunkWidth };
+        for (int i=0; i<3; ++i) {
+            if (box[i] < -maxEditApron || box[i] > corners[i] || box[i + 3] <= 0 || box[i + 3] > corners[i] - box[i] + 1) return nullptr;
+        }
+
+        std::shared_ptr<EditBrick> brick = std::make_shared<EditBrick>();
+        brick->minX = box[0]; brick->minY = box[1]; brick->minZ = box[2];
+        brick->sizeX = box[3]; brick->sizeY = box[4]; brick->sizeZ = box[5];
+        size_t count = static_cast<size_t>(brick->sizeX) * brick->sizeY * brick->sizeZ;
+        brick->values = std::vector<float>(count, 0.0f);
+
+        size_t read = sizeof(box);
+        size_t written = 0;
+        while (written < count)
+        {
+            uint32_t runs[2];
+            if (size - read < sizeof(runs)) return nullptr;
+            std::memcpy(runs, data + read, sizeof(runs));
+            read += sizeof(runs);
+            if (runs[0] == 0 && runs[1] == 0) return nullptr;
+
+            size_t literalBytes = static_cast<size_t>(runs[1]) * sizeof(float);
+            if (runs[0] > count - written || runs[1] > count - written - runs[0]) return nullptr;
+            if (size - read < literalBytes) return nullptr;
+
+            written += runs[0];
+            std::memcpy(brick->values.data() + written, data + read, literalBytes);
+            written += runs[1];
+            read += literalBytes;
+        }
+
+        // RUNS LEFT OVER WOULD DECODE PAST THE BRICK
+        if (read != size) return nullptr;
+        return brick;
+    }
+}
+
+// READ ONLY MAPPING OF A WHOLE FILE
+class MappedFile
+{
+public:
+    ~MappedFile() { Close(); }
+
+    bool Open(const std::string& path)
+    {
+        Close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) { Close(); return false; }
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) { Close(); return false; }
+        data = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data == nullptr) { Close(); return false; }
+        size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) { Close(); return false; }
+        void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) { Close(); return false; }
+        data = static_cast<const unsigned char*>(view);
+        size = static_cast<size_t>(info.st_size);
+#endif
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (data) UnmapViewOfFile(data);
+        if (mapping != NULL) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data) munmap(const_cast<unsigned char*>(data), size);
+        if (fd >= 0) close(fd);
+        fd = -1;
+#endif
+        data = nullptr;
+        size = 0;
+    }
+
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* Data() const { return data; }
+    size_t Size() const { return size; }
+
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+};
+
+class RegionFile
+{
+public:
+    RegionFile(const std::string& path, int chunkWidth, int chunkHeight) : path(path), chunkWidth(chunkWidth), chunkHeight(chunkHeight) {}
+
+    bool Exists() const { return std::filesystem::exists(path); }
+
+    // NULL WHEN THE CHUNK HAS NO STORED EDITS
+    std::shared_ptr<EditBrick> Read(int localIndex)
+    {
+        if (!Map()) return nullptr;
+
+        Region::TableEntry entry;
+        std::memcpy(&entry, file.Data() + Region::tableOffset + localIndex * sizeof(Region::TableEntry), sizeof(entry));
+        if (entry.offset == 0 || entry.offset < Region::payloadOffset) return nullptr;
+        if (static_cast<size_t>(entry.offset) + entry.size > file.Size()) return nullptr;
+        return Region::Decode(file.Data() + entry.offset, entry.size, chunkWidth, chunkHeight);
+    }
+
+    bool Write(int localIndex, const EditBrick& brick)
+    {
+        std::vector<unsigned char> payload = Region::Encode(brick);
+
+        // UNMAP FIRST - WINDOWS WON'T RESIZE A MAPPED FILE, THE NEXT READ REMAPS
+        Region::TableEntry entry = { 0, 0 };
+        bool mapped = Map();
+        if (mapped) std::memcpy(&entry, file.Data() + Region::tableOffset + localIndex * sizeof(Region::TableEntry), sizeof(entry));
+        file.Close();
+
+        // ONLY A FILE THAT WAS READ AND IS STALE IS REPLACED - ONE THAT FAILED TO OPEN STILL HOLDS OTHER CHUNKS' EDITS,
+        // SO THE BRICK STAYS DIRTY AND IS SAVED AGAIN LATER
+        if (!mapped && Exists() && !stale) return false;
+        if (!mapped)
+        {
+            if (!Create()) return false;
+            entry = { 0, 0 };
+        }
+
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        if (!stream) return false;
+
+        // OVERWRITE IN PLACE WHEN THE NEW PAYLOAD FITS, OTHERWISE APPEND
+        if (entry.offset == 0 || payload.size() > entry.size)
+        {
+            stream.seekp(0, std::ios::end);
+            entry.offset = static_cast<uint32_t>(stream.tellp());
+        }
+        entry.size = static_cast<uint32_t>(payload.size());
+        stream.seekp(entry.offset);
+        stream.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+
+        stream.seekp(Region::tableOffset + localIndex * sizeof(Region::TableEntry));
+        stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+        return static_cast<bool>(stream);
+    }
+
+private:
+    std::string path;
+    int chunkWidth;
+    int chunkHeight;
+    MappedFile file;
+    bool valid = false;
+    bool stale = false; // THE FILE WAS READ BUT IS FROM AN OLDER VERSION OR CHUNK SIZE, OR TOO SHORT FOR ITS TABLE
+
+    // MAPS THE FILE IF IT EXISTS AND WAS WRITTEN WITH THE SAME VERSION AND CHUNK DIMENSIONS
+    bool Map()
+    {
+        if (file.IsOpen()) return valid;
+        valid = false;
+        stale = false;
+        if (!file.Open(path))
+        {
+            // AN EMPTY FILE (A CREATE THAT NEVER FINISHED) CAN'T BE MAPPED BUT HOLDS NOTHING EITHER
+            std::error_code error;
+            stale = std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) == 0 && !error;
+            return false;
+        }
+
+        Region::Header header = {};
+        if (file.Size() >= sizeof(header)) std::memcpy(&header, file.Data(), sizeof(header));
+        valid = file.Size() >= Region::payloadOffset && header.magic == Region::magic && header.version == Region::version &&
+                header.chunkWidth == chunkWidth && header.chunkHeight == chunkHeight;
+        stale = !valid;
+        return valid;
+    }
+
+    // NEW FILE WITH AN EMPTY TABLE - REPLACES A FILE FROM AN OLDER VERSION OR CHUNK SIZE
+    bool Create()
+    {
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if (!stream) return false;
+        Region::Header header = { Region::magic, Region::version, chunkWidth, chunkHeight };
+        std::vector<Region::TableEntry> table(Region::chunksPerRegion, Region::TableEntry{ 0, 0 });
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        stream.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(Region::TableEntry));
+        stale = false;
+        return static_cast<bool>(stream);
+    }
+};
+
+// ALL REGION FILES OF ONE WORLD - CHUNKS ARE ADDRESSED BY THEIR WORLD POSITION LIKE EVERYWHERE ELSE
+class RegionStore
+{
+public:
+    RegionStore(const std::string& directory, int chunkWidth, int chunkHeight)
+        : directory(directory), chunkWidth(chunkWidth), chunkHeight(chunkHeight)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+    }
+
+    std::shared_ptr<EditBrick> Load(int x, int y, int z)
+    {
+        RegionFile* region = GetRegion(x, y, z, false);
+        if (region == nullptr) return nullptr;
+        return region->Read(LocalIndex(x, y, z));
+    }
+
+    bool Save(int x, int y, int z, const EditBrick& brick)
+    {
+        return GetRegion(x, y, z, true)->Write(LocalIndex(x, y, z), brick);
+    }
+
+    // UNMAPS AND CLOSES REGIONS WITH NO CHUNK INSIDE THE BOX OF CHUNK POSITIONS - A LATER LOAD OR SAVE REOPENS THEM
+    void EvictOutside(int minX, int maxX, int minY, int maxY, int minZ, int maxZ)
+    {
+        int regionWidth = Region::regionSize * chunkWidth;
+        int regionHeight = Region::regionSize * chunkHeight;
+        for (auto it = regions.begin(); it != regions.end();)
+        {
+            const OpenRegion& region = it->second;
+            int x = region.rx * regionWidth;
+            int y = region.ry * regionHeight;
+            int z = region.rz * regionWidth;
+            if (x + regionWidth <= minX || x > maxX || y + regionHeight <= minY || y > maxY || z + regionWidth <= minZ || z > maxZ) it = regions.erase(it);
+            else ++it;
+        }
+    }
+
+private:
+    std::string directory;
+    int chunkWidth;
+    int chunkHeight;
+
+    // OPEN REGIONS STAY MAPPED UNTIL EVICTED, A NULL FILE MARKS A REGION KNOWN TO HAVE NO FILE SO MISSES DON'T TOUCH THE DISK TWICE
+    struct OpenRegion
+    {
+        int rx, ry, rz;
+        std::unique_ptr<RegionFile> file;
+    };
+    std::unordered_map<uint64_t, OpenRegion> regions;
+
+    void RegionCoords(int x, int y, int z, int& rx, int& ry, int& rz) const
+    {
+        rx = FloorDiv(FloorDiv(x, chunkWidth),  Region::regionSize);
+        ry = FloorDiv(FloorDiv(y, chunkHeight), Region::regionSize);
+        rz = FloorDiv(FloorDiv(z, chunkWidth),  Region::regionSize);
+    }
+
+    int LocalIndex(int x, int y, int z) const
+    {
+        int lx = WrapIndex(FloorDiv(x, chunkWidth),  Region::regionSize);
+        int ly = WrapIndex(FloorDiv(y, chunkHeight), Region::regionSize);
+        int lz = WrapIndex(FloorDiv(z, chunkWidth),  Region::regionSize);
+        return lx + ly * Region::regionSize + lz * Region::regionSize * Region::regionSize;
+    }
+
+    RegionFile* GetRegion(int x, int y, int z, bool create)
+    {
+        int rx, ry, rz;
+        RegionCoords(x, y, z, rx, ry, rz);
+        uint64_t key = PackCoords(rx, ry, rz);
+
+        auto found = regions.find(key);
+        if (found != regions.end() && (found->second.file || !create)) return found->second.file.get();
+
+        std::string path = directory + "/r." + std::to_string(rx) + "." + std::to_string(ry) + "." + std::to_string(rz) + ".region";
+        std::unique_ptr<RegionFile> region = std::make_unique<RegionFile>(path, chunkWidth, chunkHeight);
+        if (!create && !region->Exists()) region.reset();
+
+        RegionFile* result = region.get();
+        regions[key] = OpenRegion{ rx, ry, rz, std::move(region) };
+        return result;
+    }
+};
+
+#endif
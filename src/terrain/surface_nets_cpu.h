@@ -0,0 +1,471 @@
+#ifndef SURFACE_NETS_CPU_H
+#define SURFACE_NETS_CPU_H
+
+#include "../vendor/glm/glm.hpp"
+#include "chunk_config.h"
+#include "chunk_job.h"
+#include "job_system.h"
+#include "density_graph.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <bit>
+
+/*
+Naive Surface Nets on the worker pool - a dual mesher with the Dispatch / Poll interface of TerrainCPU.
+Every cell the surface passes through gets one vertex, at the mean of its crossed edges, and every crossed edge
+becomes a quad joining the four cells around it. That is one vertex per surface cell instead of one per crossed edge,
+and no slivers from the case table - src/tools/mesher_benchmark.cpp compares the two meshers.
+The quads of edges on a chunk's -X -Y -Z faces need the cells across them, so each chunk samples an apron of one
+corner layer beyond those faces (surface heights included, from the world's surface graph). A chunk owns the edges
+whose lower corner lies in [0, cells) on every axis; the edges on its + faces belong to the next chunk, whose apron
+cells are the same cells computed from the same samples, so neighbours meet exactly.
+Same steps as TerrainCPU, slab by slab: densities, row bit masks and counts, a prefix sum for the exact output size,
+then vertices, then quads (split along their shorter diagonal, which needs every vertex in place).
+LOD transition faces are not stitched - worlds meshed with it keep every chunk at full resolution.
+*/
+
+class SurfaceNetsCPU
+{
+public:
+    static constexpr int width = ChunkConfig::width;
+    static constexpr int height = ChunkConfig::height;
+    static constexpr int slabCells = 4; // CORNER LAYERS PER SLAB TASK
+
+    static_assert(width + 2 < 64, "CORNER ROWS WITH THE APRON ARE 64 BIT MASKS");
+
+    // pool MUST OUTLIVE THIS MESHER - TASKS STILL QUEUED WHEN IT SHUTS DOWN ARE DROPPED
+    SurfaceNetsCPU(WorkerPool& pool, const TerrainShape& shape = DefaultTerrainShape())
+        : pool(pool), surface(shape.surface), density(shape.density) {}
+
+    // QUEUES EVERY SLAB OF THE JOBS ON THE POOL - DOES NOT WAIT FOR THEM
+    void Dispatch(std::vector<std::shared_ptr<ChunkJob>>& jobs)
+    {
+        if (jobs.empty()) return;
+
+        std::shared_ptr<std::atomic<int>> batch = std::make_shared<std::atomic<int>>(static_cast<int>(jobs.size()));
+        batches.push_back(batch);
+
+        for (std::shared_ptr<ChunkJob>& job : jobs)
+        {
+            std::shared_ptr<MeshTask> task = std::make_shared<MeshTask>();
+            task->job = job;
+            task->batch = batch;
+            task->stride = 1 << job->lod;
+            task->cells[0] = width / task->stride;
+            task->cells[1] = height / task->stride;
+            task->cells[2] = width / task->stride;
+            for (int a=0; a<3; ++a) task->samples[a] = task->cells[a] + 2;
+            task->slabCount = (task->samples[2] + slabCells - 1) / slabCells;
+            task->densities.resize(task->samples[0] * task->samples[1] * task->samples[2]);
+            task->rows.resize(task->samples[1] * task->samples[2]);
+            task->activeRows = ActiveCellRows(*job, task->cells[1], task->cells[2], task->stride);
+            FindSampledRows(*task);
+
+            ForEachSlab(task, &SurfaceNetsCPU::FillSlab, [this](std::shared_ptr<MeshTask> task) {
+                ForEachSlab(task, &SurfaceNetsCPU::ClassifySlab, [this](std::shared_ptr<MeshTask> task) {
+                    AllocateOutput(*task);
+                    ForEachSlab(task, &SurfaceNetsCPU::EmitVertices, [this](std::shared_ptr<MeshTask> task) {
+                        ForEachSlab(task, &SurfaceNetsCPU::EmitQuads, [this](std::shared_ptr<MeshTask> task) { Finish(*task); });
+                    });
+                });
+            });
+        }
+    }
+
+    // COLLECTS EVERY JOB THE WORKERS HAVE FINISHED MESHING - NEVER BLOCKS
+    void Poll(std::vector<std::shared_ptr<ChunkJob>>& finishedJobs)
+    {
+        std::vector<std::shared_ptr<ChunkJob>> meshed;
+        completedJobs.PopAll(meshed);
+        for (std::shared_ptr<ChunkJob>& job : meshed) {
+            if (!job->cancelled) finishedJobs.push_back(job);
+        }
+        batches.erase(std::remove_if(batches.begin(), batches.end(),
+            [](const std::shared_ptr<std::atomic<int>>& batch) { return *batch == 0; }), batches.end());
+    }
+
+    int BatchesInFlight() const
+    {
+        return static_cast<int>(std::count_if(batches.begin(), batches.end(),
+            [](const std::shared_ptr<std::atomic<int>>& batch) { return *batch > 0; }));
+    }
+
+    float DensityThreshold() const { return densityThreshold; }
+
+private:
+    float densityThreshold = 0.7f; // SAME AS TerrainGPU
+
+    // ONE ROW OF SAMPLES ALONG X - BIT i IS SAMPLE i, OR THE CELL STARTING AT IT
+    struct SampleRow
+    {
+        uint64_t cells = 0;       // SURFACE CELLS AROUND AN OWNED EDGE - ONE VERTEX EACH
+        uint64_t crossed[3] = {}; // OWNED SAMPLES WHOSE +X +Y +Z EDGE THE SURFACE CROSSES - ONE QUAD EACH
+        int firstVertex = 0;      // PLACE IN THE OUTPUT, FROM THE PREFIX SUM
+        int firstIndex = 0;
+    };
+
+    // ONE CHUNK ON THE WORKERS - SHARED BY ITS SLAB TASKS
+    // SAMPLE i ON AN AXIS IS CORNER i - 1 OF THE CHUNK AT THIS LOD, SO SAMPLE 0 IS THE APRON
+    struct MeshTask
+    {
+        std::shared_ptr<ChunkJob> job;
+        std::shared_ptr<std::atomic<int>> batch;
+        int stride = 1;
+        int cells[3] = { 0, 0, 0 };   // PER AXIS AT THIS LOD, WITHOUT THE APRON
+        int samples[3] = { 0, 0, 0 }; // cells + 2 - THE APRON AND THE + FACE
+        int slabCount = 1;
+        std::vector<float> densities; // ONE PER SAMPLE, X FASTEST
+        std::vector<SampleRow> rows;  // ONE PER (Y, Z), Y FASTEST
+        std::vector<char> activeRows;  // ONE PER CELL ROW (Y, Z) OF THE CHUNK, APRON EXCLUDED, Y FASTEST - SEE ActiveCellRows
+        std::vector<char> sampledRows; // ONE PER SAMPLE ROW - THE ROWS THE VERTICES AROUND ACTIVE EDGES READ, THE ONLY ONES EVALUATED
+        std::atomic<int> remaining{0}; // SLABS STILL RUNNING THE CURRENT STEP
+
+        int Lattice(int x, int y, int z) const { return x + (y + z * samples[1]) * samples[0]; }
+        float Density(int x, int y, int z) const { return densities[Lattice(x, y, z)]; }
+        SampleRow& Row(int y, int z) { return rows[y + z * samples[1]]; }
+        const SampleRow& Row(int y, int z) const { return rows[y + z * samples[1]]; }
+        bool Active(int y, int z) const { return y >= 0 && z >= 0 && y < cells[1] && z < cells[2] && activeRows[y + z * cells[1]]; } // CHUNK CELL ROW
+        bool Sampled(int y, int z) const { return sampledRows[y + z * samples[1]]; }
+
+        // SAMPLE LAYERS z0 <= z < z1 OF SLAB s
+        void Layers(int s, int& z0, int& z1) const
+        {
+            z0 = s * slabCells;
+            z1 = std::min(z0 + slabCells, samples[2]);
+        }
+
+        // INDEX OF THE VERTEX OF CELL (x, y, z) - ITS ROW'S FIRST VERTEX PLUS THE CELLS WITH A VERTEX BEFORE IT
+        unsigned int CellVertex(const int c[3]) const
+        {
+            const SampleRow& row = Row(c[1], c[2]);
+            return static_cast<unsigned int>(row.firstVertex + std::popcount(row.cells & ((uint64_t(1) << c[0]) - 1)));
+        }
+    };
+
+    WorkerPool& pool;
+    DensityKernel surface;
+    DensityKernel density;
+    std::vector<std::shared_ptr<std::atomic<int>>> batches; // JOBS OF EACH DISPATCH STILL ON THE WORKERS
+    CompletionQueue<std::shared_ptr<ChunkJob>> completedJobs;
+
+    // RUNS step ON EVERY SLAB, THEN then ON THE WORKER THAT FINISHES THE LAST ONE - A CANCELLED JOB SKIPS STRAIGHT TO Finish
+    template <typename Then>
+    void ForEachSlab(std::shared_ptr<MeshTask> task, void (SurfaceNetsCPU::*step)(MeshTask&, int), Then then)
+    {
+        task->remaining = task->slabCount;
+        for (int s=0; s<task->slabCount; ++s)
+        {
+            pool.Submit([this, task, s, step, then] {
+                if (!task->job->cancelled) (this->*step)(*task, s);
+                if (task->remaining.fetch_sub(1) != 1) return;
+                if (task->job->cancelled) Finish(*task);
+                else then(task);
+            });
+        }
+    }
+
+    // THE CORNERS OF ACTIVE CELL ROW (y, z) ARE SAMPLE ROWS y + 1 AND y + 2 - THE CELLS AROUND THEIR EDGES REACH ONE ROW FURTHER
+    static void FindSampledRows(MeshTask& t)
+    {
+        t.sampledRows.assign(t.rows.size(), 0);
+        for (int z=0; z<t.cells[2]; ++z) {
+            for (int y=0; y<t.cells[1]; ++y)
+            {
+                if (!t.Active(y, z)) continue;
+                for (int rz=z; rz<=std::min(z + 3, t.samples[2] - 1); ++rz)
+                    for (int ry=y; ry<=std::min(y + 3, t.samples[1] - 1); ++ry) t.sampledRows[ry + rz * t.samples[1]] = 1;
+            }
+        }
+    }
+
+    // STEP 1 - DENSITIES OF THE SLAB'S SAMPLED ROWS, THEIR COLUMNS' SURFACE HEIGHTS FIRST - THE OTHER ROWS ARE NEVER READ
+    // THE APRON COLUMNS AREN'T IN THE JOB'S ColumnHeights, SO EVERY COLUMN COMES FROM THE SURFACE GRAPH - BOTH CHUNKS
+    // AT A SEAM THEN SEE THE SAME HEIGHTS, BIT FOR BIT
+    void FillSlab(MeshTask& t, int s)
+    {
+        ChunkJob& job = *t.job;
+        int z0, z1;
+        t.Layers(s, z0, z1);
+        thread_local std::vector<int> sampled; // (Y, Z) OF EACH SAMPLED ROW
+        sampled.clear();
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<t.samples[1]; ++y) {
+                if (t.Sampled(y, z)) sampled.push_back(y + z * t.samples[1]);
+            }
+        }
+        if (sampled.empty()) return;
+
+        int columnCount = t.samples[0] * (z1 - z0);
+        int count = static_cast<int>(sampled.size()) * t.samples[0];
+        thread_local std::vector<float> columnX, columnZ, columnHeight, xs, ys, zs, heights;
+        columnX.resize(columnCount);
+        columnZ.resize(columnCount);
+        columnHeight.resize(columnCount);
+        xs.resize(count);
+        ys.resize(count);
+        zs.resize(count);
+        heights.resize(count);
+
+        for (int z=z0, i=0; z<z1; ++z) {
+            for (int x=0; x<t.samples[0]; ++x, ++i) {
+                columnX[i] = static_cast<float>(job.x + (x - 1) * t.stride);
+                columnZ[i] = static_cast<float>(job.z + (z - 1) * t.stride);
+            }
+        }
+        surface.Evaluate(columnX.data(), columnHeight.data(), columnZ.data(), columnHeight.data(), columnHeight.data(), columnCount);
+
+        for (int r=0, i=0; r<static_cast<int>(sampled.size()); ++r)
+        {
+            int y = sampled[r] % t.samples[1];
+            int z = sampled[r] / t.samples[1];
+            for (int x=0; x<t.samples[0]; ++x, ++i) {
+                int column = x + (z - z0) * t.samples[0];
+                xs[i] = columnX[column];
+                ys[i] = static_cast<float>(job.y + (y - 1) * t.stride);
+                zs[i] = columnZ[column];
+                heights[i] = columnHeight[column];
+            }
+        }
+
+        // THE BOX IS THE WHOLE SLAB'S, SKIPPED ROWS OR NOT - CAVE GRADIENTS COME FROM ITS LATTICES
+        const float lo[3] = { columnX[0], static_cast<float>(job.y - t.stride), columnZ[0] };
+        const float hi[3] = { columnX[columnCount - 1], static_cast<float>(job.y + (t.samples[1] - 2) * t.stride), columnZ[columnCount - 1] };
+        thread_local std::vector<float> values;
+        values.resize(count);
+        density.EvaluateInBox(xs.data(), ys.data(), zs.data(), heights.data(), values.data(), count, lo, hi);
+
+        // ROWS ARE CONTIGUOUS IN THE LATTICE - EDITS ARE ADDED SAMPLE BY SAMPLE, THE APRON'S INCLUDED
+        for (int r=0; r<static_cast<int>(sampled.size()); ++r)
+        {
+            int y = sampled[r] % t.samples[1];
+            int z = sampled[r] / t.samples[1];
+            float* out = &t.densities[t.Lattice(0, y, z)];
+            std::memcpy(out, &values[r * t.samples[0]], t.samples[0] * sizeof(float));
+            if (!job.edits) continue;
+            for (int x=0; x<t.samples[0]; ++x) out[x] += job.edits->Get((x - 1) * t.stride, (y - 1) * t.stride, (z - 1) * t.stride);
+        }
+    }
+
+    // STEP 2 - MASKS OF THE SLAB'S ROWS: CROSSED OWNED EDGES FOR THE QUADS, THE CELLS AROUND THEM FOR THE VERTICES
+    // A SURFACE CELL NO OWNED EDGE TOUCHES (ON THE APRON'S FAR SIDE OR THE + FACES) GETS NO VERTEX - THE NEIGHBOUR HAS IT
+    void ClassifySlab(MeshTask& t, int s)
+    {
+        int z0, z1;
+        t.Layers(s, z0, z1);
+        int rowLength = t.samples[0];
+        uint64_t ownedBits = ((uint64_t(1) << t.cells[0]) - 1) << 1; // SAMPLES 1 .. cells, CORNERS 0 .. cells - 1
+
+        // THE CELLS OF THE SLAB'S LAST LAYER NEED THE EDGES OF THE NEXT ONE, WHICH NEED THE LAYER AFTER IT
+        int zEnd = std::min(z1 + 2, t.samples[2]);
+        thread_local std::vector<uint64_t> above;
+        above.resize(t.samples[1] * (zEnd - z0));
+        for (int z=z0; z<zEnd; ++z) {
+            for (int y=0; y<t.samples[1]; ++y) {
+                if (!t.Sampled(y, z)) above[y + (z - z0) * t.samples[1]] = 0;
+                else above[y + (z - z0) * t.samples[1]] = DensitySIMD::AboveMask(&t.densities[t.Lattice(0, y, z)], rowLength, densityThreshold);
+            }
+        }
+        auto Above = [&](int y, int z) { return above[y + (z - z0) * t.samples[1]]; };
+        // AN OWNED EDGE FROM CORNER ROW (y - 1, z - 1) LIES IN THE CHUNK CELL ROWS AROUND IT - IN ROWS THE BOUNDS RULED
+        // OUT IT HAS NO CROSSING, SO THE ROWS ARE SKIPPED AND THEIR DENSITIES NEVER FILLED
+        auto Crossed = [&](int axis, int y, int z) -> uint64_t {
+            if (y < 1 || y > t.cells[1] || z < 1 || z > t.cells[2]) return 0;
+            bool side = t.Active(y - 1, z - 1) || (axis != 1 && t.Active(y - 2, z - 1)) || (axis != 2 && t.Active(y - 1, z - 2)) ||
+                        (axis == 0 && t.Active(y - 2, z - 2));
+            if (!side) return 0;
+            uint64_t a = Above(y, z);
+            uint64_t b = axis == 0 ? a >> 1 : (axis == 1 ? Above(y + 1, z) : Above(y, z + 1));
+            return (a ^ b) & ownedBits;
+        };
+
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<t.samples[1]; ++y)
+            {
+                SampleRow& row = t.Row(y, z);
+                for (int axis=0; axis<3; ++axis) row.crossed[axis] = Crossed(axis, y, z);
+
+                // AN X EDGE TOUCHES THE CELLS OF ITS ROW AND THE 3 ROWS BELOW, A Y OR Z EDGE THOSE OF 2 ROWS, ON BOTH SIDES IN X
+                row.cells = 0;
+                if (y + 1 == t.samples[1] || z + 1 == t.samples[2]) continue;
+                uint64_t alongX = Crossed(0, y, z) | Crossed(0, y + 1, z) | Crossed(0, y, z + 1) | Crossed(0, y + 1, z + 1);
+                uint64_t across = Crossed(1, y, z) | Crossed(1, y, z + 1) | Crossed(2, y, z) | Crossed(2, y + 1, z);
+                row.cells = alongX | across | (across >> 1);
+            }
+        }
+    }
+
+    // STEP 3 - EXCLUSIVE PREFIX SUM OF THE ROW COUNTS, ONE ALLOCATION
+    void AllocateOutput(MeshTask& t)
+    {
+        int vertexCount = 0;
+        int indexCount = 0;
+        for (SampleRow& row : t.rows)
+        {
+            row.firstVertex = vertexCount;
+            row.firstIndex = indexCount;
+            vertexCount += std::popcount(row.cells);
+            indexCount += (std::popcount(row.crossed[0]) + std::popcount(row.crossed[1]) + std::popcount(row.crossed[2])) * 6;
+        }
+        t.job->rawVertices.resize(vertexCount * 6);
+        t.job->rawIndices.resize(indexCount);
+    }
+
+    // STEP 4 - ONE VERTEX PER SURFACE CELL OF THE SLAB'S ROWS
+    void EmitVertices(MeshTask& t, int s)
+    {
+        int z0, z1;
+        t.Layers(s, z0, z1);
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<t.samples[1]; ++y)
+            {
+                const SampleRow& row = t.Row(y, z);
+                float* vertex = t.job->rawVertices.data() + row.firstVertex * 6;
+                for (uint64_t cells = row.cells; cells != 0; cells &= cells - 1) {
+                    vertex = WriteVertex(t, std::countr_zero(cells), y, z, vertex);
+                }
+            }
+        }
+    }
+
+    // MEAN OF THE CELL'S EDGE CROSSINGS, NORMAL ALONG THE GRADIENT OF THE CELL'S TRILINEAR DENSITY THERE - IT ONLY READS
+    // THE CELL'S 8 CORNERS, SO A CELL SHARED WITH A NEIGHBOUR'S APRON GETS THE SAME NORMAL IN BOTH CHUNKS
+    float* WriteVertex(const MeshTask& t, int x, int y, int z, float* out) const
+    {
+        float d[2][2][2];
+        for (int k=0; k<2; ++k)
+            for (int j=0; j<2; ++j)
+                for (int i=0; i<2; ++i) d[i][j][k] = t.Density(x + i, y + j, z + k);
+
+        glm::vec3 sum(0.0f);
+        glm::vec3 fallback(0.0f);
+        int crossings = 0;
+        for (int axis=0; axis<3; ++axis) {
+            for (int e=0; e<4; ++e)
+            {
+                int c0[3], c1[3];
+                int u = (axis + 1) % 3;
+                int v = (axis + 2) % 3;
+                c0[axis] = 0;
+                c1[axis] = 1;
+                c0[u] = c1[u] = e & 1;
+                c0[v] = c1[v] = e >> 1;
+                float d0 = d[c0[0]][c0[1]][c0[2]];
+                float d1 = d[c1[0]][c1[1]][c1[2]];
+                if ((d0 > densityThreshold) == (d1 > densityThreshold)) continue;
+
+                glm::vec3 point(c0[0], c0[1], c0[2]);
+                point[axis] = (densityThreshold - d0) / (d1 - d0);
+                sum += point;
+                fallback[axis] += d1 > d0 ? 1.0f : -1.0f;
+                crossings += 1;
+            }
+        }
+        glm::vec3 p = sum / static_cast<float>(crossings);
+
+        // PARTIAL DERIVATIVES OF THE TRILINEAR INTERPOLATION AT p
+        glm::vec3 normal;
+        for (int axis=0; axis<3; ++axis)
+        {
+            int u = (axis + 1) % 3;
+            int v = (axis + 2) % 3;
+            float derivative = 0.0f;
+            for (int e=0; e<4; ++e)
+            {
+                int c0[3], c1[3];
+                c0[axis] = 0;
+                c1[axis] = 1;
+                c0[u] = c1[u] = e & 1;
+                c0[v] = c1[v] = e >> 1;
+                float weight = ((e & 1) ? p[u] : 1.0f - p[u]) * ((e >> 1) ? p[v] : 1.0f - p[v]);
+                derivative += weight * (d[c1[0]][c1[1]][c1[2]] - d[c0[0]][c0[1]][c0[2]]);
+            }
+            normal[axis] = derivative;
+        }
+
+        // ALONG THE GRADIENT LIKE THE MARCHING CUBES MESHERS - A FLAT CELL FALLS BACK TO ITS CROSSINGS' DIRECTIONS
+        if (glm::dot(normal, normal) < 1e-12f) normal = fallback;
+        if (glm::dot(normal, normal) < 1e-12f) normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        normal = glm::normalize(normal);
+
+        out[0] = (static_cast<float>(x - 1) + p.x) * t.stride;
+        out[1] = (static_cast<float>(y - 1) + p.y) * t.stride;
+        out[2] = (static_cast<float>(z - 1) + p.z) * t.stride;
+        out[3] = normal.x;
+        out[4] = normal.y;
+        out[5] = normal.z;
+        return out + 6;
+    }
+
+    // STEP 5 - ONE QUAD PER CROSSED OWNED EDGE OF THE SLAB'S ROWS, WRITTEN WHERE THE PREFIX SUM PUT THEM
+    void EmitQuads(MeshTask& t, int s)
+    {
+        int z0, z1;
+        t.Layers(s, z0, z1);
+        for (int z=z0; z<z1; ++z) {
+            for (int y=0; y<t.samples[1]; ++y)
+            {
+                const SampleRow& row = t.Row(y, z);
+                unsigned int* index = t.job->rawIndices.data() + row.firstIndex;
+                for (uint64_t samples = row.crossed[0] | row.crossed[1] | row.crossed[2]; samples != 0; samples &= samples - 1)
+                {
+                    int p[3] = { std::countr_zero(samples), y, z };
+                    for (int axis=0; axis<3; ++axis) {
+                        if (row.crossed[axis] >> p[0] & 1) index = WriteQuad(t, p, axis, index);
+                    }
+                }
+            }
+        }
+    }
+
+    // THE FOUR CELLS AROUND THE EDGE FROM SAMPLE p ALONG axis, WOUND SO THE FACE NORMAL POINTS UP THE DENSITY GRADIENT
+    // LIKE MARCHING CUBES' TRIANGLES - SPLIT ALONG THE SHORTER DIAGONAL
+    unsigned int* WriteQuad(const MeshTask& t, const int p[3], int axis, unsigned int* out) const
+    {
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        int cells[4][3];
+        const int offsets[4][2] = { {-1, -1}, {0, -1}, {0, 0}, {-1, 0} }; // COUNTER CLOCKWISE ABOUT +axis
+        for (int c=0; c<4; ++c)
+        {
+            cells[c][axis] = p[axis];
+            cells[c][u] = p[u] + offsets[c][0];
+            cells[c][v] = p[v] + offsets[c][1];
+        }
+
+        unsigned int quad[4];
+        for (int c=0; c<4; ++c) quad[c] = t.CellVertex(cells[c]);
+        int q[3] = { p[0], p[1], p[2] };
+        q[axis] += 1;
+        if (t.Density(q[0], q[1], q[2]) < t.Density(p[0], p[1], p[2])) std::swap(quad[1], quad[3]);
+
+        const float* vertices = t.job->rawVertices.data();
+        auto Distance2 = [vertices](unsigned int a, unsigned int b) {
+            glm::vec3 d(vertices[a * 6] - vertices[b * 6], vertices[a * 6 + 1] - vertices[b * 6 + 1], vertices[a * 6 + 2] - vertices[b * 6 + 2]);
+            return glm::dot(d, d);
+        };
+        if (Distance2(quad[0], quad[2]) <= Distance2(quad[1], quad[3]))
+        {
+            unsigned int triangles[6] = { quad[0], quad[1], quad[2], quad[0], quad[2], quad[3] };
+            std::copy(triangles, triangles + 6, out);
+        }
+        else
+        {
+            unsigned int triangles[6] = { quad[1], quad[2], quad[3], quad[1], quad[3], quad[0] };
+            std::copy(triangles, triangles + 6, out);
+        }
+        return out + 6;
+    }
+
+    // HANDS THE JOB BACK - A CANCELLED JOB'S OUTPUT IS NEVER READ
+    void Finish(MeshTask& t)
+    {
+        completedJobs.Push(t.job);
+        *t.batch -= 1;
+    }
+};
+
+#endif
@@ -1,39 +1,107 @@
 #pragma once
-#include <unordered_map>
 #include "marching_cubes_gpu.h"
+#include "marching_cubes_cpu.h"
+#include "surface_nets_cpu.h"
+#include "mesh_decimation.h"
+#include "chunk_grid.h"
+#include "chunk_scheduler.h"
+#include "frame_budget.h"
+#include "job_system.h"
+#include "region_file.h"
+#include "chunk_cache.h"
+#include "column_cache.h"
 #include "../vendor/glm/glm.hpp"
 #include "../raycast.h"
 #include "../model.h"
 #include "../error.h"
 
-struct TupleHash {
-    template <class T1, class T2, class T3>
-    std::size_t operator()(const std::tuple<T1, T2, T3>& tuple) const {
-        auto h1 = std::hash<T1>{}(std::get<0>(tuple));
-        auto h2 = std::hash<T2>{}(std::get<1>(tuple));
-        auto h3 = std::hash<T3>{}(std::get<2>(tuple));
-        // Combine hash values using a bitwise XOR and a shift
-        return h1 ^ (h2 << 1) ^ (h3 << 2);
-    }
+// WHERE CHUNKS ARE MESHED - THE CPU BACKEND NEEDS NO OPENGL CONTEXT FOR MESHING
+enum class MeshBackend
+{
+    GPU,  // TerrainGPU's COMPUTE SHADER
+    CPU   // TerrainCPU ON THE WORKER POOL
+};
+
+// HOW A WORLD'S CHUNKS ARE TURNED INTO TRIANGLES
+enum class MeshAlgorithm
+{
+    MarchingCubes, // TerrainGPU OR TerrainCPU, WITH LOD RINGS
+    SurfaceNets    // SurfaceNetsCPU ON THE WORKER POOL, EVERY CHUNK AT FULL RESOLUTION
 };
 
 class TerrainSystem
 {
 public:
 
-    TerrainSystem()
+    // noise IS THE 3D NOISE BACKEND THE CAVES ARE CARVED WITH
+    TerrainSystem(MeshBackend backend = MeshBackend::GPU, MeshAlgorithm algorithm = MeshAlgorithm::MarchingCubes, NoiseBackend noise = NoiseBackend::Hash)
+        : shape(DefaultTerrainShape(noise)), surfaceKernel(shape.surface)
     {
-        terrainGPU.width = width;
-        terrainGPU.height = height;
+        // ONLY THE SELECTED MESHER IS BUILT - THE COMPUTE SHADER NEEDS AN OPENGL CONTEXT
+        if (algorithm == MeshAlgorithm::SurfaceNets)
+        {
+            // NO LOD TRANSITION STITCHING YET, AND ITS QUADS READ ONE CORNER LAYER BEYOND THE CHUNK'S - FACES
+            surfaceNets = std::make_unique<SurfaceNetsCPU>(workerPool, shape);
+            lodRings.clear();
+            editApron = 1;
+            seamLayers = 1;
+        }
+        else if (backend == MeshBackend::GPU) terrainGPU = std::make_unique<TerrainGPU>(shape);
+        else terrainCPU = std::make_unique<TerrainCPU>(workerPool, shape);
+
+        // ONE MODEL PER GRID SLOT, REUSED BY EVERY CHUNK THAT OCCUPIES THE SLOT
+        // THE GRID COVERS THE UNLOAD BOX SO CHUNKS KEPT BY HYSTERESIS NEVER SHARE A SLOT
+        grid.Init(renderDistanceH + 2 * unloadMargin, renderDistanceV + 2 * unloadMargin, renderDistanceH + 2 * unloadMargin, width, height);
+        for (int i=0; i<grid.SlotCount(); ++i) models.push_back(new Model);
+        columns.surface = &surfaceKernel;
+    }
+    ~TerrainSystem() 
+    {
+        // EDITED CHUNKS STILL LOADED OR CACHED AT EXIT
+        for (int i=0; i<grid.SlotCount(); ++i) {
+            if (grid.slots[i].loaded) SaveEdits(grid.slots[i]);
+        }
+        std::vector<CachedChunk> dropped;
+        cache.DropAll(dropped);
+        SaveDroppedEdits(dropped);
+        for (Model* model : models) delete model;
     }
-    ~TerrainSystem() {}
 
     std::vector<Model*> models;
-    std::unordered_map<std::tuple<int, int, int>, size_t, TupleHash> chunkPosToIndex;
+    ChunkScheduler scheduler;
+    FrameBudget budget;
+    ChunkCache cache;
+    ColumnCache columns;
+    int regenerationsAvoided = 0; // CHUNKS THAT CAME BACK INTO THE LOAD BOX BEFORE HYSTERESIS LET THEM GO
+
+    // QUADRIC EDGE COLLAPSE OF EVERY NEW MESH ON THE WORKERS - decimationErrors[d] IS THE BUDGET (WORLD UNITS) OF CHUNKS
+    // d CHUNKS FROM THE PLAYER'S, THE LAST ONE COVERS EVERY CHUNK FURTHER OUT. A CHUNK CHANGING BUDGET IS REMESHED
+    bool decimation = false;
+    std::vector<float> decimationErrors = { 0.05f, 0.1f, 0.1f, 0.25f, 0.25f, 0.5f };
+    std::atomic<long> trianglesBeforeDecimation{0};
+    std::atomic<long> trianglesAfterDecimation{0};
+
+    // MULTI-RESOLUTION DENSITY - LOD 0 CHUNKS SAMPLE THEIR LOW FREQUENCY OCTAVES ON COARSER GRIDS, WITHIN maxError OF THE
+    // EXACT DENSITY. ONLY THE CPU MARCHING CUBES MESHER OF THE HASH NOISE TERRAIN HAS IT - 0 TURNS IT OFF. CALL BEFORE Update
+    void SetDensityError(float maxError)
+    {
+        densityError = 0.0f;
+        if (maxError <= 0.0f) return;
+        if (!terrainCPU || !shape.bounded) {
+            std::cout << "ERROR: multi-resolution density needs the CPU marching cubes mesher and hash noise - using exact densities" << std::endl;
+            return;
+        }
+        densityError = terrainCPU->SetMultiResolution(maxError);
+    }
 
-    void Update(float playerX, float playerY, float playerZ)
+    void Update(float playerX, float playerY, float playerZ, const glm::mat4& projectionView)
     {
-        // COORDINATES OF CHUNK THAT BOUNDS THE PLAYER
+        budget.BeginFrame();
+
+        // COORDINATES OF CHUNK THAT BOUNDS THE PLAYER - LOD RINGS ARE CENTRED ON IT
+        lodCenterX = std::round(playerX / width)  * width;
+        lodCenterY = std::round(playerY / height) * height;
+        lodCenterZ = std::round(playerZ / width)  * width;
         int minChunkX = (std::round(playerX / width)  * width)  -(renderDistanceH - 1) * width  / 2;
         int minChunkY = (std::round(playerY / height) * height) -(renderDistanceV - 1) * height / 2;
 	    int minChunkZ = (std::round(playerZ / width)  * width)  -(renderDistanceH - 1) * width  / 2;
@@ -41,96 +109,149 @@ public:
         int maxChunkY = minChunkY + renderDistanceV * height - 1;
         int maxChunkZ = minChunkZ + renderDistanceH * width - 1;
 
-        // CHECK ALL CHUNKS TO SEE IF THEY ARE INSIDE RENDER DISTANCE
+        // HAND FINISHED PIPELINE WORK TO THE CHUNKS BEFORE THE CHUNK LIST CHANGES
+        CollectFinishedJobs();
+
+        // CHUNKS ARE LOADED INSIDE THE RENDER BOX BUT ONLY UNLOADED ONCE THEY LEAVE THE LARGER UNLOAD BOX
+        int unloadMinX = minChunkX - unloadMargin * width;
+        int unloadMinY = minChunkY - unloadMargin * height;
+        int unloadMinZ = minChunkZ - unloadMargin * width;
+        int unloadMaxX = maxChunkX + unloadMargin * width;
+        int unloadMaxY = maxChunkY + unloadMargin * height;
+        int unloadMaxZ = maxChunkZ + unloadMargin * width;
+
+        // EVICT LOADED CHUNKS OUTSIDE THE UNLOAD BOX - ANY LEFT OVER ARE EVICTED NEXT FRAME OR WHEN THEIR SLOT IS NEEDED
+        auto unloadStart = FrameBudget::Now();
         int chunksRemoved = 0;
-        for (int i=0; i<chunks.size(); ++i) {
-            bool inRenderDist = chunks[i].x >= minChunkX && chunks[i].x <= maxChunkX && 
-                                chunks[i].y >= minChunkY && chunks[i].y <= maxChunkY && 
-                                chunks[i].z >= minChunkZ && chunks[i].z <= maxChunkZ;
-            if (!inRenderDist)
+        for (int i=0; i<grid.SlotCount(); ++i) {
+            Chunk& chunk = grid.slots[i];
+            if (!chunk.loaded) continue;
+            bool inRenderDist = chunk.x >= minChunkX && chunk.x <= maxChunkX && 
+                                chunk.y >= minChunkY && chunk.y <= maxChunkY && 
+                                chunk.z >= minChunkZ && chunk.z <= maxChunkZ;
+            bool inUnloadDist = chunk.x >= unloadMinX && chunk.x <= unloadMaxX && 
+                                chunk.y >= unloadMinY && chunk.y <= unloadMaxY && 
+                                chunk.z >= unloadMinZ && chunk.z <= unloadMaxZ;
+            if (inRenderDist)
+            {
+                if (chunk.retained) regenerationsAvoided += 1;
+                chunk.retained = false;
+            }
+            else if (inUnloadDist)
             {
-                chunkPosToIndex.erase(std::make_tuple(chunks[i].x, chunks[i].y, chunks[i].z));
+                chunk.retained = true;
+            }
+            else
+            {
+                // OUT OF BUDGET - ONLY THE EVICTION WAITS, THE LOOP STILL KEEPS THE OTHER CHUNKS' BOOKKEEPING
+                if (budget.Enabled() && !budget.CanAfford(budget.unloadCost.averageMs)) continue;
+                EvictChunk(i);
+                chunksRemoved += 1;
+            }
+        }
+        budget.unloadCost.Record(FrameBudget::MillisecondsSince(unloadStart), chunksRemoved);
 
-                // DECREMENT EVERY FOLLOWING CHUNK INDEX
-                for (int k=i+1; k<chunks.size(); ++k)
-                {
-                    chunkPosToIndex[std::make_tuple(chunks[k].x, chunks[k].y, chunks[k].z)] -= 1; // POTENTIAL OPTIMISATION!! FROM O(n^2) to O(n) - perform one pass over the chunkPosToIndex elements rather than multiple passes
-                }
+        // A COLUMN'S SURFACE HEIGHTS GO ONCE NO CHUNK OF IT CAN STILL BE LOADED
+        columns.EvictOutside(unloadMinX, unloadMaxX, unloadMinZ, unloadMaxZ);
 
-                // THIS CAN BE OPTIMISED FURTHER
-                delete models[i];
-                models.erase(models.begin() + i);
-                chunks.erase(chunks.begin() + i);
-                chunksRemoved += 1;
-                --i;
+        // SAME FOR REGION FILES - OTHERWISE A LONG FLIGHT KEEPS EVERY ONE IT PASSED MAPPED AND OPEN
+        regionStore.EvictOutside(unloadMinX, unloadMaxX, unloadMinY, unloadMaxY, unloadMinZ, unloadMaxZ);
+
+        // QUEUE EVERY MISSING CHUNK - VISIBLE AND NEAREST FIRST
+        scheduler.Begin(glm::vec3(playerX, playerY, playerZ), projectionView);
+        for (int y=0; y <renderDistanceV; ++y) {
+            for (int x=0; x <renderDistanceH; ++x) {
+                for (int z=0; z<renderDistanceH; ++z) {
+                    int chunkX = (x * width)  + minChunkX;
+                    int chunkY = (y * height) + minChunkY;
+                    int chunkZ = (z * width)  + minChunkZ;
+                    if (grid.Find(chunkX, chunkY, chunkZ) != nullptr) continue;
 
-                if (chunksRemoved > 2) break;
+                    glm::vec3 boundsMin = glm::vec3(chunkX - width/2, chunkY - height/2, chunkZ - width/2);
+                    glm::vec3 boundsMax = boundsMin + glm::vec3(width, height, width);
+                    scheduler.Request(chunkX, chunkY, chunkZ, boundsMin, boundsMax);
+                }
             }
         }
 
-        // GENERATE 8 CHUNKS PER FRAME
-        int chunksGenerated = 0;
+        // START NEW CHUNKS IN PRIORITY ORDER - RECENTLY EVICTED CHUNKS COME BACK FROM THE CACHE, 
+        // THE REST ARE CLASSIFIED ON THE WORKERS
+        int chunksStarted = 0;
+        while (chunksStarted < maxChunksPerBatch && jobsClassifying < maxJobsClassifying && !scheduler.Empty())
+        {
+            ChunkRequest request = scheduler.Pop();
+            int slot = grid.SlotIndex(request.x, request.y, request.z);
+            if (grid.slots[slot].loaded) EvictChunk(slot); // STALE CHUNK LEFT OVER BY A BUDGETED UNLOAD
+
+            Chunk& chunk = grid.slots[slot];
+            chunk.x = request.x;
+            chunk.y = request.y;
+            chunk.z = request.z;
+            chunk.loaded = true;
+            chunk.retained = false;
+            if (RestoreCachedChunk(slot)) continue;
 
-        std::vector<Chunk*> chunksToGeneratePtrs;
-        std::vector<Model*> modelsToGeneratePtrs;
+            chunk.regenerate = false;
+            chunk.contents = ChunkContents::Unknown;
+            chunk.edits.Restore(regionStore.Load(chunk.x, chunk.y, chunk.z));
+            StartJob(chunk, true);
+            chunksStarted += 1;
+        }
 
-        // REGENERATE CHUNKS - EXCLUDE OUTERMOST
-        for (int i=0; i<chunks.size(); ++i) {
-            bool inRenderDist = chunks[i].x > minChunkX && chunks[i].x < maxChunkX && 
-                                chunks[i].y > minChunkY && chunks[i].y < maxChunkY && 
-                                chunks[i].z > minChunkZ && chunks[i].z < maxChunkZ;
+        // MESHER IS STILL BUSY WITH EARLIER BATCHES - DON'T QUEUE MORE WORK BEHIND THEM
+        if (BatchesInFlight() >= maxBatchesInFlight) return;
 
-            // REGENERATE CHUNK
-            if (inRenderDist && chunks[i].regenerate)
+        // REGENERATE EDITED CHUNKS - EXCLUDE OUTERMOST
+        // THE OLD MESH STAYS VISIBLE UNTIL THE NEW ONE IS HANDED OFF
+        for (int i=0; i<grid.SlotCount(); ++i) {
+            Chunk& chunk = grid.slots[i];
+            if (!chunk.loaded || !chunk.regenerate) continue;
+            bool inRenderDist = chunk.x > minChunkX && chunk.x < maxChunkX && 
+                                chunk.y > minChunkY && chunk.y < maxChunkY && 
+                                chunk.z > minChunkZ && chunk.z < maxChunkZ;
+            if (inRenderDist)
             {
-                chunks[i].regenerate = false;
-                models[i]->vertices.clear();
-                models[i]->indices.clear();
-                chunksToGeneratePtrs.push_back(&chunks[i]);
-                modelsToGeneratePtrs.push_back(models[i]);
-                chunksGenerated += 1;
+                chunk.regenerate = false;
+                StartJob(chunk, false);
             }
+        }
 
-            if (chunksGenerated >= 4) goto endOfGenerationCheck;
+        // REMESH CHUNKS WHOSE LOD, TRANSITION FACES OR DECIMATION BUDGET CHANGED AS THE RINGS MOVED - BEHIND NEW AND EDITED CHUNKS
+        for (int i=0; i<grid.SlotCount(); ++i) {
+            Chunk& chunk = grid.slots[i];
+            if (!chunk.loaded || chunk.contents != ChunkContents::Mixed) continue;
+            int meshLod = chunk.job ? chunk.job->lod : chunk.lod;
+            int meshTransitions = chunk.job ? chunk.job->transitionMask : chunk.transitionMask;
+            float meshError = chunk.job ? chunk.job->decimationError : chunk.decimationError;
+            if (meshLod != LodAt(chunk.x, chunk.y, chunk.z) || meshTransitions != TransitionMaskAt(chunk.x, chunk.y, chunk.z) ||
+                meshError != DecimationErrorAt(chunk.x, chunk.y, chunk.z))
+            {
+                StartJob(chunk, false, false);
+            }
         }
 
-        // GENERATE NEW CHUNKS
-        for (int y=0; y <renderDistanceV; ++y) {
-            for (int x=0; x <renderDistanceH; ++x) {
-                for (int z=0; z<renderDistanceH; ++z) {
-                    int chunkX = (x * width)  + minChunkX;
-                    int chunkY = (y * height) + minChunkY;
-                    int chunkZ = (z * width)  + minChunkZ;
+        // MESH AS MANY CHUNKS AS THE FRAME BUDGET ALLOWS
+        int chunksGenerated = 0;
+        std::vector<std::shared_ptr<ChunkJob>> jobsToGenerate;
+        while (CanGenerateMore(chunksGenerated) && !meshQueue.empty())
+        {
+            std::shared_ptr<ChunkJob> job = meshQueue.front();
+            meshQueue.pop_front();
+            if (job->cancelled) continue;
 
-                    // NO CHUNK AT LOCATION -> GENERATE ONE
-                    auto pos = std::make_tuple(chunkX, chunkY, chunkZ);
-                    auto it = chunkPosToIndex.find(pos);
-                    if (it == chunkPosToIndex.end()) 
-                    {
-                        Chunk newChunk;
-                        newChunk.x = chunkX;
-                        newChunk.y = chunkY;
-                        newChunk.z = chunkZ;
-                        newChunk.densities = std::vector<float>((width+1)*(width+1)*(height+1), 0.0f);
-                        chunks.push_back(newChunk);
-                        chunkPosToIndex[std::make_tuple(chunkX, chunkY, chunkZ)] = chunks.size() -1;
-
-                        Model* model = new Model;
-                        models.push_back(model);
-
-                        chunksToGeneratePtrs.push_back(&chunks[chunks.size()-1]);
-                        modelsToGeneratePtrs.push_back(model);
-                        chunksGenerated += 1;
-                    }
+            Chunk* chunk = grid.Find(job->x, job->y, job->z);
+            if (chunk == nullptr || chunk->job != job) continue;
 
-                    if (chunksGenerated >= 4) goto endOfGenerationCheck;
-                }
-            }
+            jobsToGenerate.push_back(job);
+            chunksGenerated += 1;
         }
-        endOfGenerationCheck:
 
-        // GENERATE ALL CHUNKS
-        terrainGPU.GenerateMeshes(chunksToGeneratePtrs, modelsToGeneratePtrs);
+        // START GENERATING ALL CHUNKS
+        auto dispatchStart = FrameBudget::Now();
+        if (terrainGPU) terrainGPU->Dispatch(jobsToGenerate);
+        else if (terrainCPU) terrainCPU->Dispatch(jobsToGenerate);
+        else surfaceNets->Dispatch(jobsToGenerate);
+        budget.dispatchCost.Record(FrameBudget::MillisecondsSince(dispatchStart), jobsToGenerate.size());
     }
     
     RayHit Raycast(glm::vec3 origin, glm::vec3 direction)
@@ -142,15 +263,18 @@ public:
         float closestHit = 1000000.0f;
 
         // RAY, CHUNK BOUNDING BOX INTERSECTION TEST
-        for (int i=0; i<chunks.size(); ++i)
+        for (int i=0; i<grid.SlotCount(); ++i)
         {   
+            Chunk& chunk = grid.slots[i];
+            if (!chunk.loaded) continue;
+
             // CONSTRUCT CHUNK BOUNDING BOX
             float hWidth = width/2;
             float hHeight = height/2;
             glm::vec3 chunkBL = glm::vec3 {
-                chunks[i].x - hWidth, 
-                chunks[i].y - hHeight, 
-                chunks[i].z - hWidth};
+                chunk.x - hWidth, 
+                chunk.y - hHeight, 
+                chunk.z - hWidth};
             BoundingBox boundingBox;
             boundingBox.min = chunkBL;
             boundingBox.max = chunkBL + glm::vec3(width, height, width);
@@ -159,23 +283,14 @@ public:
             if (RayIntersectsBox(ray, boundingBox))
             {
                 // LOOP OVER MODEL INDICES TO EXTRACT TRIANGLE VERTICES
-                for (int k=0; k<models[i]->indices.size(); k+=3) 
+                for (int k=0; k<models[i]->IndexCount(); k+=3) 
                 {
-                    int v1Index = models[i]->indices[k + 0];
-                    int v2Index = models[i]->indices[k + 1];
-                    int v3Index = models[i]->indices[k + 2];
-                    glm::vec3 v1 = glm::vec3{
-                        models[i]->vertices[v1Index * 6 + 0] + models[i]->position.x, 
-                        models[i]->vertices[v1Index * 6 + 1] + models[i]->position.y, 
-                        models[i]->vertices[v1Index * 6 + 2] + models[i]->position.z};
-                    glm::vec3 v2 = glm::vec3{
-                        models[i]->vertices[v2Index * 6 + 0] + models[i]->position.x, 
-                        models[i]->vertices[v2Index * 6 + 1] + models[i]->position.y, 
-                        models[i]->vertices[v2Index * 6 + 2] + models[i]->position.z};
-                    glm::vec3 v3 = glm::vec3{
-                        models[i]->vertices[v3Index * 6 + 0] + models[i]->position.x, 
-                        models[i]->vertices[v3Index * 6 + 1] + models[i]->position.y, 
-                        models[i]->vertices[v3Index * 6 + 2] + models[i]->position.z};
+                    int v1Index = models[i]->Index(k + 0);
+                    int v2Index = models[i]->Index(k + 1);
+                    int v3Index = models[i]->Index(k + 2);
+                    glm::vec3 v1 = models[i]->VertexPosition(v1Index) + models[i]->position;
+                    glm::vec3 v2 = models[i]->VertexPosition(v2Index) + models[i]->position;
+                    glm::vec3 v3 = models[i]->VertexPosition(v3Index) + models[i]->position;
                     
                     // RAY TRIANGLE INTERSECTION WITH EVERY FACE
                     RayHit newhit = RayTriangleIntersection(ray, v1, v2, v3);
@@ -199,9 +314,10 @@ public:
         int snapWorldZ = std::round(position.z);
         
         // FOR EACH CHUNK
-        for (int i = 0; i < chunks.size(); ++i) 
+        for (int i = 0; i < grid.SlotCount(); ++i) 
         {
-            Chunk& chunk = chunks[i];
+            Chunk& chunk = grid.slots[i];
+            if (!chunk.loaded) continue;
 
             // FOR EACH CORNER
             for (int x = snapWorldX - radius + 1; x < snapWorldX + radius; ++x) {
@@ -209,21 +325,22 @@ public:
             for (int z = snapWorldZ - radius + 1; z < snapWorldZ + radius; ++z) 
                     {
                         int cornerLocalX = x + width/2 - chunk.x;
-                        int cornerLocalY = y + width/2 - chunk.y;
+                        int cornerLocalY = y + height/2 - chunk.y;
                         int cornerLocalZ = z + width/2 - chunk.z;
 
-                        // IF CORNER POSITION IS INSIDE CHUNK
-                        if (cornerLocalX >= 0 && cornerLocalX <= width &&
-                            cornerLocalY >= 0 && cornerLocalY <= height &&
-                            cornerLocalZ >= 0 && cornerLocalZ <= width)
+                        // IF CORNER POSITION IS INSIDE CHUNK OR THE APRON ITS MESHER SAMPLES
+                        if (cornerLocalX >= -editApron && cornerLocalX <= width &&
+                            cornerLocalY >= -editApron && cornerLocalY <= height &&
+                            cornerLocalZ >= -editApron && cornerLocalZ <= width)
                         {
 
                             // IF DIST FROM SNAP POS TO CORNER POS <= RADIUS
                             float distance = glm::distance(glm::vec3(snapWorldX, snapWorldY, snapWorldZ), glm::vec3(x, y, z));
                             if (distance <= radius) 
                             {
-                                int densityIndex = GetDensityIndex(cornerLocalX, cornerLocalY, cornerLocalZ);
-                                chunk.densities[densityIndex] += amount;
+                                // THE FIRST EDIT ALLOCATES THE CHUNK'S EDIT BRICK
+                                chunk.edits.Add(cornerLocalX, cornerLocalY, cornerLocalZ, amount);
+                                chunk.contents = ChunkContents::Mixed;
                                 chunk.regenerate = true;
                             }
                         }
@@ -234,15 +351,288 @@ public:
     }
 
 private:
-    TerrainGPU terrainGPU;
-    std::vector<Chunk> chunks;
+    // THE WORLD'S TERRAIN - DECLARED BEFORE THE MESHERS, WHICH COMPILE ITS DENSITY GRAPH
+    TerrainShape shape;
+    DensityKernel surfaceKernel;
+    std::unique_ptr<TerrainGPU> terrainGPU;      // EXACTLY ONE OF THE THREE MESHERS IS SET
+    std::unique_ptr<TerrainCPU> terrainCPU;      // THE CPU MESHERS ONLY KEEP A REFERENCE TO THE POOL DECLARED BELOW
+    std::unique_ptr<SurfaceNetsCPU> surfaceNets;
+    int editApron = 0; // CORNER LAYERS BEFORE A CHUNK'S - FACES ITS MESHER READS, EDITS THERE REMESH IT TOO
+    int seamLayers = 0; // CELL LAYERS BEFORE A CHUNK'S + FACES THE NEXT CHUNK'S MESH SHARES - DECIMATION LOCKS THEM
+    float densityError = 0.0f; // BOUND ON HOW FAR THE MESHER'S DENSITIES ARE FROM THE EXACT ONES - THE CLASSIFIER'S MARGIN
+    ChunkGrid grid;
+
+    int renderDistanceH = ChunkConfig::renderDistanceH;
+    int renderDistanceV = ChunkConfig::renderDistanceV;
+    int unloadMargin = 2; // CHUNKS A CHUNK MAY DRIFT OUTSIDE THE RENDER BOX BEFORE IT IS UNLOADED
 
-    int renderDistanceH = 17;
-    int renderDistanceV = 9;
-    int width = 12;
-    int height = 12;
+    // CHUNKS MORE THAN lodRings[k] CHUNKS FROM THE PLAYER'S CHUNK ARE MESHED AT LOD k + 1 (CELLS 2^(k+1) CORNERS WIDE)
+    // RINGS MUST BE AT LEAST ONE CHUNK APART SO NEIGHBOURS NEVER DIFFER BY MORE THAN ONE LOD
+    std::vector<int> lodRings = { 3, 5 };
+    int lodCenterX = 0;
+    int lodCenterY = 0;
+    int lodCenterZ = 0;
+    static constexpr int width = ChunkConfig::width;
+    static constexpr int height = ChunkConfig::height;
+    int maxBatchesInFlight = 3;
+    int maxChunksPerFrame = 4;  // FIXED COUNT USED WHEN THE FRAME BUDGET IS DISABLED
+    int maxChunksPerBatch = ChunkConfig::maxChunksPerBatch; // CAPS GPU BUFFER SIZES WHEN THE FRAME BUDGET IS ENABLED
 
-    int GetDensityIndex(int x, int y, int z) {
-        return x + (y * (width + 1)) + (z * (width + 1) * (height + 1));
+    // EDITS OF UNLOADED CHUNKS - DECLARED AFTER THE CHUNK DIMENSIONS IT IS CONSTRUCTED FROM
+    RegionStore regionStore{ChunkConfig::WorldDirectory(), width, height};
+
+    // FIXED COUNT MODE OR AS MANY CHUNKS AS THE MEASURED STAGE COSTS FIT IN THE BUDGET - ALWAYS AT LEAST ONE
+    bool CanGenerateMore(int chunksGenerated)
+    {
+        if (!budget.Enabled()) return chunksGenerated < maxChunksPerFrame;
+        if (chunksGenerated >= maxChunksPerBatch) return false;
+        if (chunksGenerated == 0) return true;
+        double perChunkMs = budget.dispatchCost.averageMs + budget.readbackCost.averageMs;
+        return budget.CanAfford(perChunkMs * (chunksGenerated + 1));
+    }
+
+    int maxJobsClassifying = 64;
+    int jobsClassifying = 0;
+    std::deque<std::shared_ptr<ChunkJob>> meshQueue; // CLASSIFIED OR EDITED CHUNKS WAITING FOR THE MESHER
+
+    // DECLARED LAST - WORKERS MUST BE JOINED BEFORE THE STATE THEY TOUCH IS DESTROYED
+    CompletionQueue<std::shared_ptr<ChunkJob>> classifiedJobs;
+    CompletionQueue<std::shared_ptr<ChunkJob>> completedJobs;
+    WorkerPool workerPool;
+
+    int BatchesInFlight() const
+    {
+        if (terrainGPU) return terrainGPU->BatchesInFlight();
+        return terrainCPU ? terrainCPU->BatchesInFlight() : surfaceNets->BatchesInFlight();
     }
-};
\ No newline at end of file
+
+    float DensityThreshold() const
+    {
+        if (terrainGPU) return terrainGPU->DensityThreshold();
+        return terrainCPU ? terrainCPU->DensityThreshold() : surfaceNets->DensityThreshold();
+    }
+
+    // CHUNKS BETWEEN (x, y, z) AND THE PLAYER'S CHUNK, DIAGONALS COUNT AS ONE
+    int ChunkDistance(int x, int y, int z) const
+    {
+        return std::max({ std::abs(x - lodCenterX) / width, std::abs(y - lodCenterY) / height, std::abs(z - lodCenterZ) / width });
+    }
+
+    int LodAt(int x, int y, int z) const
+    {
+        int distance = ChunkDistance(x, y, z);
+        int lod = 0;
+        while (lod < static_cast<int>(lodRings.size()) && distance > lodRings[lod]) lod += 1;
+        return std::min(lod, ChunkConfig::MaxLod());
+    }
+
+    // FACES (-X +X -Y +Y -Z +Z) WHOSE NEIGHBOUR IS MESHED ONE LOD COARSER - THIS CHUNK STITCHES ITSELF TO THEM
+    int TransitionMaskAt(int x, int y, int z) const
+    {
+        int lod = LodAt(x, y, z);
+        int neighbours[6][3] = { {-width, 0, 0}, {width, 0, 0}, {0, -height, 0}, {0, height, 0}, {0, 0, -width}, {0, 0, width} };
+        int mask = 0;
+        for (int face=0; face<6; ++face) {
+            if (LodAt(x + neighbours[face][0], y + neighbours[face][1], z + neighbours[face][2]) > lod) mask |= 1 << face;
+        }
+        return mask;
+    }
+
+    // DECIMATION BUDGET OF A CHUNK'S MESH - 0 WHEN DECIMATION IS OFF
+    float DecimationErrorAt(int x, int y, int z) const
+    {
+        if (!decimation || decimationErrors.empty()) return 0.0f;
+        return decimationErrors[std::min(ChunkDistance(x, y, z), static_cast<int>(decimationErrors.size()) - 1)];
+    }
+
+    // NEW CHUNKS ARE CLASSIFIED FIRST, EDITED CHUNKS GO STRAIGHT TO THE FRONT OF THE MESH QUEUE, LOD CHANGES TO THE BACK
+    void StartJob(Chunk& chunk, bool classify, bool urgent = true)
+    {
+        // AN OLDER JOB FOR THIS CHUNK IS SUPERSEDED BY THE NEW ONE
+        if (chunk.job) chunk.job->cancelled = true;
+
+        std::shared_ptr<ChunkJob> job = std::make_shared<ChunkJob>();
+        job->x = chunk.x;
+        job->y = chunk.y;
+        job->z = chunk.z;
+        job->edits = chunk.edits.Snapshot();
+        job->surface = columns.Acquire(chunk.x, chunk.z);
+        job->lod = LodAt(chunk.x, chunk.y, chunk.z);
+        job->transitionMask = TransitionMaskAt(chunk.x, chunk.y, chunk.z);
+        job->decimationError = DecimationErrorAt(chunk.x, chunk.y, chunk.z);
+        chunk.job = job;
+
+        if (classify)
+        {
+            jobsClassifying += 1;
+            float densityThreshold = DensityThreshold();
+            bool bounded = shape.bounded;
+            float margin = densityError;
+            workerPool.Submit([this, job, densityThreshold, bounded, margin] {
+                // THE BOUNDS ONLY KNOW THE DEFAULT SHAPE - CHUNKS OF OTHER SHAPES ARE ALL MESHED
+                if (!job->cancelled && !bounded) job->contents = ChunkContents::Mixed;
+                else if (!job->cancelled) 
+                {
+                    job->contents = ClassifyChunk(job->surface->Values(), job->x, job->y, job->z, densityThreshold, job->edits.get(), job->activeBlocks, margin);
+                }
+                classifiedJobs.Push(job);
+            });
+        }
+        else
+        {
+            job->contents = ChunkContents::Mixed;
+            chunk.contents = ChunkContents::Mixed;
+            if (urgent) meshQueue.push_front(job);
+            else meshQueue.push_back(job);
+        }
+    }
+
+    void CollectFinishedJobs()
+    {
+        // CLASSIFIED CHUNKS -> MESH QUEUE, EMPTY AND SOLID CHUNKS ARE DONE HERE
+        std::vector<std::shared_ptr<ChunkJob>> classified;
+        classifiedJobs.PopAll(classified);
+        for (std::shared_ptr<ChunkJob>& job : classified)
+        {
+            jobsClassifying -= 1;
+            if (job->cancelled) continue;
+
+            Chunk* chunk = grid.Find(job->x, job->y, job->z);
+            if (chunk == nullptr || chunk->job != job) continue;
+
+            chunk->contents = job->contents;
+            if (job->contents == ChunkContents::Mixed) meshQueue.push_back(job);
+            else chunk->job.reset();
+        }
+
+        // MESHER -> WORKER THREADS
+        std::vector<std::shared_ptr<ChunkJob>> meshedJobs;
+        auto readbackStart = FrameBudget::Now();
+        if (terrainGPU) terrainGPU->Poll(meshedJobs);
+        else if (terrainCPU) terrainCPU->Poll(meshedJobs);
+        else surfaceNets->Poll(meshedJobs);
+        budget.readbackCost.Record(FrameBudget::MillisecondsSince(readbackStart), meshedJobs.size());
+        for (std::shared_ptr<ChunkJob>& job : meshedJobs)
+        {
+            workerPool.Submit([this, job] {
+                if (job->cancelled) return;
+                if (job->decimationError > 0.0f) DecimateChunk(*job);
+                BuildChunkModel(*job);
+                completedJobs.Push(job);
+            });
+        }
+
+        // WORKER THREADS -> MAIN THREAD
+        std::vector<std::shared_ptr<ChunkJob>> builtJobs;
+        completedJobs.PopAll(builtJobs);
+        for (std::shared_ptr<ChunkJob>& job : builtJobs)
+        {
+            if (job->cancelled) continue;
+
+            Chunk* chunk = grid.Find(job->x, job->y, job->z);
+            if (chunk == nullptr || chunk->job != job) continue;
+
+            // SWAP THE FINISHED MESH INTO THE LIVE MODEL
+            Model* model = models[grid.SlotIndex(job->x, job->y, job->z)];
+            model->vertices.swap(job->model.vertices);
+            model->indices.swap(job->model.indices);
+            model->wideIndices.swap(job->model.wideIndices);
+            model->position = job->model.position;
+            model->boundingBox = job->model.boundingBox;
+            chunk->lod = job->lod;
+            chunk->transitionMask = job->transitionMask;
+            chunk->decimationError = job->decimationError;
+            chunk->job.reset();
+        }
+    }
+
+    // WORKER THREADS - VERTICES ON THE CHUNK FACES AND IN THE SHARED SEAM LAYERS STAY PUT SO NEIGHBOURS STILL JOIN
+    void DecimateChunk(ChunkJob& job)
+    {
+        long before = static_cast<long>(job.rawIndices.size() / 3);
+        float seam = static_cast<float>(seamLayers << job.lod);
+        glm::vec3 lockMax = glm::vec3(width - seam, height - seam, width - seam);
+        MeshDecimation::Decimate(job.rawVertices, job.rawIndices, job.decimationError, glm::vec3(0.0f), lockMax);
+        trianglesBeforeDecimation += before;
+        trianglesAfterDecimation += static_cast<long>(job.rawIndices.size() / 3);
+    }
+
+    void EvictChunk(int slot)
+    {
+        Chunk& chunk = grid.slots[slot];
+
+        // SETTLED CHUNKS MOVE INTO THE CACHE - THEIR EDITS ARE SAVED WHEN THE CACHE DROPS THEM
+        if (!chunk.job && chunk.contents != ChunkContents::Unknown && cache.budgetBytes > 0)
+        {
+            CachedChunk cached;
+            cached.x = chunk.x;
+            cached.y = chunk.y;
+            cached.z = chunk.z;
+            cached.contents = chunk.contents;
+            cached.regenerate = chunk.regenerate;
+            cached.lod = chunk.lod;
+            cached.transitionMask = chunk.transitionMask;
+            cached.decimationError = chunk.decimationError;
+            cached.vertices.swap(models[slot]->vertices);
+            cached.indices.swap(models[slot]->indices);
+            cached.wideIndices.swap(models[slot]->wideIndices);
+            cached.position = models[slot]->position;
+            cached.boundingBox = models[slot]->boundingBox;
+            cached.editsDirty = chunk.edits.Dirty();
+            cached.edits = chunk.edits.Release();
+
+            std::vector<CachedChunk> dropped;
+            cache.Insert(std::move(cached), dropped);
+            SaveDroppedEdits(dropped);
+        }
+
+        // CANCEL ANY GENERATION STILL IN THE PIPELINE
+        if (chunk.job) chunk.job->cancelled = true;
+        chunk.job.reset();
+        chunk.loaded = false;
+        chunk.regenerate = false;
+        chunk.contents = ChunkContents::Unknown;
+        SaveEdits(chunk);
+        chunk.edits.Clear();
+
+        models[slot]->vertices.clear();
+        models[slot]->indices.clear();
+        models[slot]->wideIndices.clear();
+    }
+
+    // MOVES A CACHED MESH AND ITS EDITS BACK INTO THE SLOT - FALSE ON A MISS
+    bool RestoreCachedChunk(int slot)
+    {
+        Chunk& chunk = grid.slots[slot];
+        CachedChunk cached;
+        if (!cache.Take(chunk.x, chunk.y, chunk.z, cached)) return false;
+
+        chunk.contents = cached.contents;
+        chunk.regenerate = cached.regenerate;
+        chunk.lod = cached.lod;
+        chunk.transitionMask = cached.transitionMask;
+        chunk.decimationError = cached.decimationError;
+        chunk.edits.Restore(cached.edits, cached.editsDirty);
+        models[slot]->vertices.swap(cached.vertices);
+        models[slot]->indices.swap(cached.indices);
+        models[slot]->wideIndices.swap(cached.wideIndices);
+        models[slot]->position = cached.position;
+        models[slot]->boundingBox = cached.boundingBox;
+        return true;
+    }
+
+    // WRITE BACK EDITS MADE SINCE THE CHUNK WAS LOADED
+    void SaveEdits(Chunk& chunk)
+    {
+        if (!chunk.edits.Dirty()) return;
+        std::shared_ptr<const EditBrick> brick = chunk.edits.Snapshot();
+        if (brick && regionStore.Save(chunk.x, chunk.y, chunk.z, *brick)) chunk.edits.MarkSaved();
+    }
+
+    void SaveDroppedEdits(std::vector<CachedChunk>& dropped)
+    {
+        for (CachedChunk& cached : dropped) {
+            if (cached.editsDirty && cached.edits) regionStore.Save(cached.x, cached.y, cached.z, *cached.edits);
+        }
+    }
+};
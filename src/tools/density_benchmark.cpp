@@ -0,0 +1,211 @@
+// THROUGHPUT AND ACCURACY OF THE CPU DENSITY EVALUATORS - NO WINDOW OR GPU NEEDED
+// clang++ -std=c++20 -O2 -mavx2 src/tools/density_benchmark.cpp -o build/density_benchmark.exe
+// WITHOUT -mavx2 BOTH COLUMNS MEASURE THE SCALAR PATH
+
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "../terrain/density_simd.h"
+#include "../terrain/density_multires.h"
+#include "../terrain/density_graph.h"
+
+// PER-CORNER SCALAR REFERENCE - SURFACE HEIGHT PER COLUMN LIKE FillChunk SO ONLY THE EVALUATOR DIFFERS
+void FillChunkScalar(int chunkX, int chunkY, int chunkZ, float* out)
+{
+    using namespace ChunkConfig;
+    for (int z=0; z<cornersX; ++z) {
+        for (int x=0; x<cornersX; ++x) {
+            float surfaceHeight = Density::GetSurfaceHeight(chunkX + x, chunkZ + z);
+            for (int y=0; y<cornersY; ++y) {
+                out[CornerIndex(x, y, z)] = Density::GetDensity(chunkX + x, chunkY + y, chunkZ + z, surfaceHeight);
+            }
+        }
+    }
+}
+
+// THE DEFAULT TERRAIN AS A DENSITY GRAPH - INTERPRETED NODE BY NODE PER CORNER, OR THROUGH THE COMPILED KERNELS
+const TerrainShape shape = DefaultTerrainShape();
+const DensityKernel surfaceKernel(shape.surface);
+const DensityKernel densityKernel(shape.density);
+
+void FillChunkInterpreted(int chunkX, int chunkY, int chunkZ, float* out)
+{
+    using namespace ChunkConfig;
+    for (int z=0; z<cornersX; ++z) {
+        for (int x=0; x<cornersX; ++x) {
+            float surfaceHeight = shape.surface.Evaluate(chunkX + x, 0.0f, chunkZ + z, 0.0f);
+            for (int y=0; y<cornersY; ++y) {
+                out[CornerIndex(x, y, z)] = shape.density.Evaluate(chunkX + x, chunkY + y, chunkZ + z, surfaceHeight);
+            }
+        }
+    }
+}
+
+void FillChunkCompiled(const DensityKernel& surfaceKernel, const DensityKernel& densityKernel, int chunkX, int chunkY, int chunkZ, float* out)
+{
+    using namespace ChunkConfig;
+    thread_local std::vector<float> xs(cornerCount), ys(cornerCount), zs(cornerCount), surface(cornerCount);
+    thread_local std::vector<float> columnX(cornersX * cornersX), columnZ(cornersX * cornersX), columnHeight(cornersX * cornersX);
+    for (int i=0; i<cornersX * cornersX; ++i) {
+        columnX[i] = static_cast<float>(chunkX + i % cornersX);
+        columnZ[i] = static_cast<float>(chunkZ + i / cornersX);
+    }
+    surfaceKernel.Evaluate(columnX.data(), columnHeight.data(), columnZ.data(), columnHeight.data(), columnHeight.data(), cornersX * cornersX);
+
+    for (int i=0; i<cornerCount; ++i) {
+        int x = i % cornersX;
+        int z = i / (cornersX * cornersY);
+        xs[i] = static_cast<float>(chunkX + x);
+        ys[i] = static_cast<float>(chunkY + i / cornersX % cornersY);
+        zs[i] = static_cast<float>(chunkZ + z);
+        surface[i] = columnHeight[x + z * cornersX];
+    }
+    densityKernel.Evaluate(xs.data(), ys.data(), zs.data(), surface.data(), out, cornerCount);
+}
+
+template<typename Fill>
+double SamplesPerSecond(Fill fill, const std::vector<int>& chunks, std::vector<float>& out)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i=0; i<chunks.size(); i += 3) {
+        fill(chunks[i], chunks[i + 1], chunks[i + 2], out.data() + (i / 3) * ChunkConfig::cornerCount);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return (chunks.size() / 3) * double(ChunkConfig::cornerCount) / seconds;
+}
+
+int main()
+{
+    using namespace ChunkConfig;
+
+    // A SLAB OF CHUNKS AROUND THE SURFACE - ABOUT HALF OF THEM NEED THE CAVE OCTAVES
+    std::vector<int> chunks;
+    for (int cz=-4; cz<4; ++cz)
+        for (int cy=-3; cy<3; ++cy)
+            for (int cx=-4; cx<4; ++cx) {
+                chunks.push_back(cx * width);
+                chunks.push_back(cy * height);
+                chunks.push_back(cz * width);
+            }
+
+    int chunkCount = static_cast<int>(chunks.size() / 3);
+    std::vector<float> scalar(chunkCount * cornerCount);
+    std::vector<float> simd(chunkCount * cornerCount);
+    std::vector<float> uncached(chunkCount * cornerCount);
+    std::vector<float> interpreted(chunkCount * cornerCount);
+    std::vector<float> compiled(chunkCount * cornerCount);
+
+    double scalarRate = SamplesPerSecond(FillChunkScalar, chunks, scalar);
+    double simdRate = SamplesPerSecond([](int x, int y, int z, float* out) { DensitySIMD::FillChunk(x, y, z, nullptr, out); }, chunks, simd);
+    double uncachedRate = SamplesPerSecond([](int x, int y, int z, float* out) { DensitySIMD::FillChunk(x, y, z, nullptr, out, false); }, chunks, uncached);
+    double interpretedRate = SamplesPerSecond(FillChunkInterpreted, chunks, interpreted);
+    double compiledRate = SamplesPerSecond([](int x, int y, int z, float* out) { FillChunkCompiled(surfaceKernel, densityKernel, x, y, z, out); }, chunks, compiled);
+
+    float maxError = 0.0f, interpretedError = 0.0f, compiledError = 0.0f;
+    for (int i=0; i<scalar.size(); ++i) {
+        maxError = std::max(maxError, std::abs(scalar[i] - simd[i]));
+        interpretedError = std::max(interpretedError, std::abs(scalar[i] - interpreted[i]));
+        compiledError = std::max(compiledError, std::abs(simd[i] - compiled[i]));
+    }
+
+    std::printf("chunk size %d, %d chunks, %d corners\n", width, chunkCount, chunkCount * cornerCount);
+    std::printf("scalar   %8.2f M samples/s (one core)\n", scalarRate / 1e6);
+    std::printf("batched  %8.2f M samples/s (one core, %d lanes)\n", simdRate / 1e6, DensitySIMD::lanes);
+    std::printf("speedup  %8.2fx\n", simdRate / scalarRate);
+    std::printf("max |scalar - batched| %g\n", maxError);
+    std::printf("batched without the gradient cache %8.2f M samples/s (cache %.2fx), %s\n", uncachedRate / 1e6, simdRate / uncachedRate,
+                std::memcmp(simd.data(), uncached.data(), simd.size() * sizeof(float)) == 0 ? "bit identical" : "DIFFERENT");
+
+    std::printf("\ndensity graph: %d + %d nodes as built, %d + %d steps compiled\n", shape.surface.NodeCount(), shape.density.NodeCount(), surfaceKernel.StepCount(), densityKernel.StepCount());
+    std::printf("interpreted %8.2f M samples/s\n", interpretedRate / 1e6);
+    std::printf("compiled    %8.2f M samples/s (%.2fx interpreted, %.2fx hand written batched)\n", compiledRate / 1e6, compiledRate / interpretedRate, compiledRate / simdRate);
+    std::printf("max |scalar - interpreted| %g, max |batched - compiled| %g\n", interpretedError, compiledError);
+
+    // NOISE BACKENDS - ONE OCTAVE AT RANDOM POINTS, THEN THE SLAB WITH EACH BACKEND'S CAVES COMPARED TO THE HASH CAVES
+    // SPREAD IS THE STANDARD DEVIATION, |GRAD| THE MEAN GRADIENT LENGTH (FEATURE SHARPNESS), SOLID THE CORNERS ABOVE
+    // THE DENSITY THRESHOLD, FLIPPED THE CORNERS ON THE OTHER SIDE OF IT THAN WITH HASH NOISE, CROSSINGS THE X EDGES
+    // THE SURFACE PASSES THROUGH PER 1000 CORNERS
+    const float densityThreshold = 0.7f; // TerrainGPU's
+    const int noiseSamples = 1 << 20;
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+    std::vector<float> px(noiseSamples), py(noiseSamples), pz(noiseSamples), noise(noiseSamples);
+    for (int i=0; i<noiseSamples; ++i) {
+        px[i] = coordinate(random);
+        py[i] = coordinate(random);
+        pz[i] = coordinate(random);
+    }
+
+    std::printf("\nbackend        scalar M/s  batched M/s  spread  |grad|  solid   flipped  crossings\n");
+    std::vector<float> hashTerrain;
+    for (NoiseBackend backend : { NoiseBackend::Hash, NoiseBackend::Permutation, NoiseBackend::OpenSimplex2 })
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (int i=0; i<noiseSamples; ++i) noise[i] = Density::Noise3D(backend, px[i], py[i], pz[i]);
+        double scalarNoiseRate = noiseSamples / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        DensitySIMD::Noise3D(px.data(), py.data(), pz.data(), 1.0f, noise.data(), noiseSamples, backend);
+        double batchedNoiseRate = noiseSamples / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double sum = 0.0, squares = 0.0, gradient = 0.0;
+        const float step = 0.01f;
+        const int gradientSamples = noiseSamples / 16;
+        for (int i=0; i<noiseSamples; ++i) {
+            sum += noise[i];
+            squares += double(noise[i]) * noise[i];
+        }
+        for (int i=0; i<gradientSamples; ++i) {
+            float dx = Density::Noise3D(backend, px[i] + step, py[i], pz[i]) - noise[i];
+            float dy = Density::Noise3D(backend, px[i], py[i] + step, pz[i]) - noise[i];
+            float dz = Density::Noise3D(backend, px[i], py[i], pz[i] + step) - noise[i];
+            gradient += std::sqrt(dx * dx + dy * dy + dz * dz) / step;
+        }
+        double mean = sum / noiseSamples;
+        double spread = std::sqrt(squares / noiseSamples - mean * mean);
+
+        TerrainShape backendShape = DefaultTerrainShape(backend);
+        DensityKernel backendSurface(backendShape.surface), backendDensity(backendShape.density);
+        std::vector<float> terrain(chunkCount * cornerCount);
+        for (int i=0; i<chunkCount; ++i) {
+            FillChunkCompiled(backendSurface, backendDensity, chunks[i * 3], chunks[i * 3 + 1], chunks[i * 3 + 2], terrain.data() + i * cornerCount);
+        }
+        if (backend == NoiseBackend::Hash) hashTerrain = terrain;
+
+        long solid = 0, flipped = 0, crossings = 0;
+        for (int i=0; i<terrain.size(); ++i) {
+            bool above = terrain[i] > densityThreshold;
+            solid += above;
+            flipped += above != (hashTerrain[i] > densityThreshold);
+            if (i % cornersX != cornersX - 1) crossings += above != (terrain[i + 1] > densityThreshold);
+        }
+        double corners = double(terrain.size());
+        std::printf("%-14s %10.2f %12.2f %7.4f %7.3f %6.1f%% %7.1f%% %10.1f\n", Density::NoiseBackendName(backend), scalarNoiseRate / 1e6, batchedNoiseRate / 1e6,
+                    spread, gradient / gradientSamples, 100.0 * solid / corners, 100.0 * flipped / corners, 1000.0 * crossings / corners);
+    }
+
+    // MULTI-RESOLUTION - EACH ERROR BOUND'S STRIDES (SURFACE OCTAVES, THEN CAVE OCTAVES) AGAINST THE FULL RESOLUTION FILL
+    std::printf("\nerror bound  surface strides  cave strides  predicted  max deviation   M samples/s  speedup\n");
+    std::vector<float> multiResolution(chunkCount * cornerCount);
+    for (float maxError : { 0.0f, 0.01f, 0.02f, 0.05f, 0.1f, 0.2f })
+    {
+        DensitySIMD::OctaveStrides strides = DensitySIMD::ChooseStrides(maxError);
+        // BEST OF 5 - THE DIFFERENCES ARE SMALLER THAN ONE RUN'S NOISE
+        double fullRate = 0.0, rate = 0.0;
+        for (int run=0; run<5; ++run) {
+            fullRate = std::max(fullRate, SamplesPerSecond([](int x, int y, int z, float* out) { DensitySIMD::FillChunk(x, y, z, nullptr, out); }, chunks, simd));
+            rate = std::max(rate, SamplesPerSecond([&](int x, int y, int z, float* out) { DensitySIMD::FillChunkMultiResolution(x, y, z, nullptr, out, strides); }, chunks, multiResolution));
+        }
+
+        float deviation = 0.0f;
+        for (int i=0; i<simd.size(); ++i) deviation = std::max(deviation, std::abs(simd[i] - multiResolution[i]));
+        const int* s = strides.surface;
+        const int* c = strides.cave;
+        std::printf("%11.3f  %2d %2d %2d %2d %2d    %2d %2d %2d %2d   %9.4f  %13.5f %13.2f %7.2fx\n", maxError, s[0], s[1], s[2], s[3], s[4], c[0], c[1], c[2], c[3],
+                    strides.error, deviation, rate / 1e6, rate / fullRate);
+    }
+    return 0;
+}
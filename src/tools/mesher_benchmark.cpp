@@ -0,0 +1,307 @@
+// MARCHING CUBES AGAINST SURFACE NETS ON THE SAME CHUNKS, LOD SEAMS, THEN QUADRIC DECIMATION OF BOTH - NO WINDOW OR GPU NEEDED
+// clang++ -std=c++20 -O2 -mavx2 src/tools/mesher_benchmark.cpp -o build/mesher_benchmark.exe
+// MESH TIME IS WALL CLOCK OVER THE WHOLE WORKER POOL, BEST OF 5 RUNS - JOBS ARE CLASSIFIED FIRST, OUTSIDE THE TIMING, LIKE TerrainSystem'S
+
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <array>
+#include "../terrain/marching_cubes_cpu.h"
+#include "../terrain/surface_nets_cpu.h"
+#include "../terrain/mesh_decimation.h"
+
+struct MeshStats
+{
+    double milliseconds = 1e30;
+    long chunksWithSurface = 0;
+    long vertices = 0;
+    long triangles = 0;
+    long bytes = 0;           // PACKED VERTEX AND INDEX BUFFERS AS UPLOADED
+    double minAngleSum = 0.0; // DEGREES
+    long slivers = 0;         // SMALLEST ANGLE UNDER 10 DEGREES
+    long degenerate = 0;      // NO AREA
+};
+
+std::vector<std::shared_ptr<ChunkJob>> MakeJobs(const std::vector<int>& chunks)
+{
+    std::vector<std::shared_ptr<ChunkJob>> jobs;
+    for (int i=0; i<chunks.size(); i += 3)
+    {
+        std::shared_ptr<ChunkJob> job = std::make_shared<ChunkJob>();
+        job->x = chunks[i];
+        job->y = chunks[i + 1];
+        job->z = chunks[i + 2];
+        job->surface = std::make_shared<ColumnHeights>(job->x, job->z, nullptr);
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+// THE CELL BLOCKS THAT MAY HOLD SURFACE, AS TerrainSystem FINDS THEM BEFORE MESHING - margin FOR MULTI-RESOLUTION DENSITIES
+void Classify(ChunkJob& job, float densityThreshold, float margin = 0.0f)
+{
+    ClassifyChunk(job.surface->Values(), job.x, job.y, job.z, densityThreshold, job.edits.get(), job.activeBlocks, margin);
+}
+
+// DISTANCE FROM p TO THE TRIANGLE abc
+float PointTriangleDistance(glm::vec3 p, glm::vec3 a, glm::vec3 b, glm::vec3 c)
+{
+    glm::vec3 n = glm::cross(b - a, c - a);
+    float area = glm::dot(n, n);
+    if (area > 1e-12f)
+    {
+        // INSIDE THE PRISM OVER THE TRIANGLE - THE PLANE IS CLOSEST
+        glm::vec3 corners[3] = { a, b, c };
+        bool inside = true;
+        for (int i=0; i<3; ++i) {
+            if (glm::dot(glm::cross(corners[(i + 1) % 3] - corners[i], p - corners[i]), n) < 0.0f) inside = false;
+        }
+        if (inside) return std::abs(glm::dot(p - a, n)) / std::sqrt(area);
+    }
+
+    // OTHERWISE AN EDGE IS
+    float closest = 1e30f;
+    glm::vec3 ends[3][2] = { { a, b }, { b, c }, { c, a } };
+    for (auto& edge : ends)
+    {
+        glm::vec3 d = edge[1] - edge[0];
+        float t = glm::dot(d, d) > 0.0f ? std::clamp(glm::dot(p - edge[0], d) / glm::dot(d, d), 0.0f, 1.0f) : 0.0f;
+        closest = std::min(closest, glm::length(p - (edge[0] + d * t)));
+    }
+    return closest;
+}
+
+// SMALLEST INTERIOR ANGLE IN DEGREES, NEGATIVE FOR A TRIANGLE WITHOUT AREA
+float MinAngle(glm::vec3 a, glm::vec3 b, glm::vec3 c)
+{
+    glm::vec3 corners[3] = { a, b, c };
+    if (glm::length(glm::cross(b - a, c - a)) < 1e-6f) return -1.0f;
+    float smallest = 180.0f;
+    for (int i=0; i<3; ++i)
+    {
+        glm::vec3 e0 = glm::normalize(corners[(i + 1) % 3] - corners[i]);
+        glm::vec3 e1 = glm::normalize(corners[(i + 2) % 3] - corners[i]);
+        smallest = std::min(smallest, glm::degrees(std::acos(std::clamp(glm::dot(e0, e1), -1.0f, 1.0f))));
+    }
+    return smallest;
+}
+
+// EDGES ON THE FACE BETWEEN A LOD 0 CHUNK AND ITS LOD 1 +X NEIGHBOUR THAT ONLY ONE TRIANGLE OF THE PAIR USES - THE FINE
+// CHUNK STITCHES ITSELF TO THE COARSE ONE, ITS DOUBLE SIDED FILL COUNTS ONCE. WITH saddles BOTH CHUNKS GET EDITS OF
+// ALTERNATING SIGN ON THE FACE'S COARSE CORNERS, SO EVERY COARSE FACE SQUARE IS A SADDLE
+long OpenSeamEdges(TerrainCPU& mesher, const std::vector<int>& chunks, bool saddles)
+{
+    using namespace ChunkConfig;
+    std::vector<std::shared_ptr<ChunkJob>> jobs = MakeJobs(chunks);
+    std::vector<std::shared_ptr<ChunkJob>> coarseJobs = MakeJobs(chunks);
+    for (int i=0; i<jobs.size(); ++i)
+    {
+        jobs[i]->transitionMask = 1 << 1;
+        coarseJobs[i]->x += width;
+        coarseJobs[i]->surface = std::make_shared<ColumnHeights>(coarseJobs[i]->x, coarseJobs[i]->z, nullptr);
+        coarseJobs[i]->lod = 1;
+        if (!saddles) continue;
+
+        for (int side=0; side<2; ++side)
+        {
+            std::shared_ptr<EditBrick> brick = std::make_shared<EditBrick>();
+            brick->minX = side == 0 ? width : 0;
+            brick->sizeX = 1;
+            brick->sizeY = height + 1;
+            brick->sizeZ = width + 1;
+            brick->values.assign(brick->sizeY * brick->sizeZ, 0.0f);
+            for (int z=0; z<=width; z += 2)
+                for (int y=0; y<=height; y += 2) brick->values[brick->Index(brick->minX, y, z)] = (y / 2 + z / 2) % 2 == 0 ? 100.0f : -100.0f;
+            (side == 0 ? jobs[i] : coarseJobs[i])->edits = brick;
+        }
+    }
+    std::vector<std::shared_ptr<ChunkJob>> all = jobs;
+    all.insert(all.end(), coarseJobs.begin(), coarseJobs.end());
+    for (std::shared_ptr<ChunkJob>& job : all) Classify(*job, mesher.DensityThreshold());
+    mesher.Dispatch(all);
+    std::vector<std::shared_ptr<ChunkJob>> finished;
+    while (finished.size() < all.size()) mesher.Poll(finished);
+
+    long open = 0;
+    for (int i=0; i<jobs.size(); ++i)
+    {
+        // VERTICES ON THE FACE ARE MERGED ACROSS THE TWO CHUNKS BY POSITION, THE OTHERS GET NEGATIVE IDS OF THEIR OWN
+        float faceX = static_cast<float>(jobs[i]->x + width);
+        int offFace = 0;
+        std::vector<glm::vec3> points;
+        std::vector<std::array<int, 3>> triangles;
+        for (const ChunkJob* job : { jobs[i].get(), coarseJobs[i].get() })
+        {
+            std::vector<int> ids(job->rawVertices.size() / 6, -1);
+            for (int v=0; v<ids.size(); ++v)
+            {
+                const float* raw = &job->rawVertices[v * 6];
+                glm::vec3 p(raw[0] + job->x, raw[1] + job->y, raw[2] + job->z);
+                if (std::abs(p.x - faceX) > 1e-4f) { ids[v] = --offFace; continue; }
+                for (int k=0; k<points.size() && ids[v] < 0; ++k) if (glm::length(points[k] - p) < 1e-3f) ids[v] = k;
+                if (ids[v] < 0) { ids[v] = static_cast<int>(points.size()); points.push_back(p); }
+            }
+            for (int k=0; k<job->rawIndices.size(); k += 3)
+            {
+                std::array<int, 3> triangle = { ids[job->rawIndices[k]], ids[job->rawIndices[k + 1]], ids[job->rawIndices[k + 2]] };
+                std::sort(triangle.begin(), triangle.end());
+                if (triangle[1] >= 0) triangles.push_back(triangle);
+            }
+        }
+        std::sort(triangles.begin(), triangles.end());
+        triangles.erase(std::unique(triangles.begin(), triangles.end()), triangles.end());
+
+        std::vector<std::pair<int, int>> edges;
+        for (const std::array<int, 3>& triangle : triangles) {
+            for (int e=0; e<3; ++e)
+            {
+                int a = triangle[e];
+                int b = triangle[(e + 1) % 3];
+                if (a >= 0 && b >= 0) edges.push_back({ std::min(a, b), std::max(a, b) });
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (int e=0; e<edges.size(); ++e) {
+            bool shared = (e > 0 && edges[e - 1] == edges[e]) || (e + 1 < edges.size() && edges[e + 1] == edges[e]);
+            if (!shared) open += 1;
+        }
+    }
+    return open;
+}
+
+template<typename Mesher>
+MeshStats Measure(Mesher& mesher, const std::vector<int>& chunks, std::vector<std::shared_ptr<ChunkJob>>& jobs, float margin = 0.0f)
+{
+    MeshStats stats;
+    for (int run=0; run<5; ++run)
+    {
+        jobs = MakeJobs(chunks);
+        for (std::shared_ptr<ChunkJob>& job : jobs) Classify(*job, mesher.DensityThreshold(), margin);
+        auto start = std::chrono::steady_clock::now();
+        mesher.Dispatch(jobs);
+        std::vector<std::shared_ptr<ChunkJob>> finished;
+        while (finished.size() < jobs.size()) mesher.Poll(finished);
+        stats.milliseconds = std::min(stats.milliseconds, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    for (std::shared_ptr<ChunkJob>& job : jobs)
+    {
+        const std::vector<float>& v = job->rawVertices;
+        const std::vector<unsigned int>& indices = job->rawIndices;
+        if (!indices.empty()) stats.chunksWithSurface += 1;
+        stats.vertices += v.size() / 6;
+        stats.triangles += indices.size() / 3;
+        stats.bytes += v.size() / 6 * sizeof(PackedVertex) + indices.size() * (v.size() / 6 > Model::maxVertices ? sizeof(uint32_t) : sizeof(uint16_t));
+        for (int i=0; i<indices.size(); i += 3)
+        {
+            const float* p[3] = { &v[indices[i] * 6], &v[indices[i + 1] * 6], &v[indices[i + 2] * 6] };
+            float angle = MinAngle(glm::vec3(p[0][0], p[0][1], p[0][2]), glm::vec3(p[1][0], p[1][1], p[1][2]), glm::vec3(p[2][0], p[2][1], p[2][2]));
+            if (angle < 0.0f) stats.degenerate += 1;
+            else
+            {
+                stats.minAngleSum += angle;
+                if (angle < 10.0f) stats.slivers += 1;
+            }
+        }
+    }
+    return stats;
+}
+
+void Print(const char* name, const MeshStats& stats, int chunkCount)
+{
+    double perChunk = std::max<long>(1, stats.chunksWithSurface);
+    long measured = std::max<long>(1, stats.triangles - stats.degenerate);
+    std::printf("%-15s %8.1f %9.3f %9.0f %9.0f %9.1f %10.1f %8.2f%% %9ld\n", name, stats.milliseconds, stats.milliseconds / chunkCount,
+                stats.vertices / perChunk, stats.triangles / perChunk, stats.bytes / perChunk / 1024.0,
+                stats.minAngleSum / measured, 100.0 * stats.slivers / measured, stats.degenerate);
+}
+
+int main()
+{
+    using namespace ChunkConfig;
+
+    // THE SAME SLAB OF CHUNKS AROUND THE SURFACE AS density_benchmark
+    std::vector<int> chunks;
+    for (int cz=-4; cz<4; ++cz)
+        for (int cy=-3; cy<3; ++cy)
+            for (int cx=-4; cx<4; ++cx) {
+                chunks.push_back(cx * width);
+                chunks.push_back(cy * height);
+                chunks.push_back(cz * width);
+            }
+    int chunkCount = static_cast<int>(chunks.size() / 3);
+
+    WorkerPool pool;
+    TerrainCPU marchingCubes(pool);
+    SurfaceNetsCPU surfaceNets(pool);
+    std::vector<std::shared_ptr<ChunkJob>> cubeJobs, netJobs;
+    MeshStats cubes = Measure(marchingCubes, chunks, cubeJobs);
+    MeshStats nets = Measure(surfaceNets, chunks, netJobs);
+
+    // MARCHING CUBES AGAIN WITH MULTI-RESOLUTION DENSITY FILLS WITHIN 0.05 OF THE EXACT DENSITY
+    TerrainCPU multiResolution(pool);
+    float densityError = multiResolution.SetMultiResolution(0.05f);
+    std::vector<std::shared_ptr<ChunkJob>> multiResolutionJobs;
+    MeshStats coarse = Measure(multiResolution, chunks, multiResolutionJobs, densityError);
+
+    // PER CHUNK COLUMNS ARE AVERAGES OVER THE CHUNKS WITH ANY SURFACE
+    std::printf("chunk size %d, %d chunks (%ld with surface), %d worker threads\n", width, chunkCount, cubes.chunksWithSurface, pool.ThreadCount());
+    std::printf("mesher          total ms  ms/chunk  verts/ch   tris/ch  KB/chunk  min angle  slivers degenerate\n");
+    Print("marching cubes", cubes, chunkCount);
+    Print("surface nets", nets, chunkCount);
+    Print("mc multi-res", coarse, chunkCount);
+    std::printf("surface nets / marching cubes: %.2fx vertices, %.2fx triangles, %.2fx memory, %.2fx time\n",
+                double(nets.vertices) / cubes.vertices, double(nets.triangles) / cubes.triangles, double(nets.bytes) / cubes.bytes, nets.milliseconds / cubes.milliseconds);
+    std::printf("multi-resolution density (error bound %.4f) / exact: %.2fx triangles, %.2fx time\n",
+                densityError, double(coarse.triangles) / cubes.triangles, coarse.milliseconds / cubes.milliseconds);
+
+    // LOD SEAMS OF MARCHING CUBES - EVERY CHUNK STITCHED TO A COARSER +X NEIGHBOUR, ON THE TERRAIN AND WITH FORCED SADDLES
+    long openEdges = OpenSeamEdges(marchingCubes, chunks, false);
+    long openSaddleEdges = OpenSeamEdges(marchingCubes, chunks, true);
+    std::printf("lod 0 / lod 1 seams, %d chunk pairs: %ld open edges, %ld with a saddle in every coarse face square\n", chunkCount, openEdges, openSaddleEdges);
+
+    // DECIMATION AT EACH BUDGET, ONE THREAD, WITH TerrainSystem's LOCKS - DEVIATION IS THE FURTHEST ANY ORIGINAL VERTEX
+    // ENDS UP FROM THE DECIMATED SURFACE, WHICH THE BUDGET BOUNDS
+    std::printf("\nmesher          budget  triangles  reduction  vertices  ms/chunk  max deviation\n");
+    for (float maxError : { 0.05f, 0.1f, 0.25f, 0.5f })
+    {
+        for (int mesher=0; mesher<2; ++mesher)
+        {
+            const std::vector<std::shared_ptr<ChunkJob>>& jobs = mesher == 0 ? cubeJobs : netJobs;
+            float seam = static_cast<float>(mesher); // SURFACE NETS SHARES THE LAST CELL LAYER WITH THE NEXT CHUNK
+            glm::vec3 lockMax = glm::vec3(width - seam, height - seam, width - seam);
+            long before = 0, after = 0, vertices = 0;
+            double seconds = 0.0;
+            float deviation = 0.0f;
+            for (const std::shared_ptr<ChunkJob>& job : jobs)
+            {
+                std::vector<float> v = job->rawVertices;
+                std::vector<unsigned int> indices = job->rawIndices;
+                auto start = std::chrono::steady_clock::now();
+                MeshDecimation::Decimate(v, indices, maxError, glm::vec3(0.0f), lockMax);
+                seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                before += job->rawIndices.size() / 3;
+                after += indices.size() / 3;
+                vertices += v.size() / 6;
+
+                for (int i=0; i<job->rawVertices.size(); i += 6)
+                {
+                    glm::vec3 p(job->rawVertices[i], job->rawVertices[i + 1], job->rawVertices[i + 2]);
+                    float nearest = 1e30f;
+                    for (int k=0; k<indices.size(); k += 3)
+                    {
+                        auto Corner = [&](int c) { return glm::vec3(v[indices[k + c] * 6], v[indices[k + c] * 6 + 1], v[indices[k + c] * 6 + 2]); };
+                        nearest = std::min(nearest, PointTriangleDistance(p, Corner(0), Corner(1), Corner(2)));
+                    }
+                    if (!indices.empty()) deviation = std::max(deviation, nearest);
+                }
+            }
+            std::printf("%-15s %6.2f %10ld %9.1f%% %9ld %9.3f %14.3f\n", mesher == 0 ? "marching cubes" : "surface nets", maxError, after,
+                        100.0 * (before - after) / std::max<long>(1, before), vertices, 1000.0 * seconds / chunkCount, deviation);
+        }
+    }
+    return 0;
+}